@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "BatchTransform.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BATCH_TRANSFORM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC allows AVX2 intrinsics in any function
+#define BATCH_TRANSFORM_AVX2_TARGET
+#else
+// GCC and clang need the instruction set enabled per function to dispatch at runtime
+#define BATCH_TRANSFORM_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#else
+#define BATCH_TRANSFORM_X86 0
+#endif
+
+namespace {
+
+using OutputLayout = BatchTransform::OutputLayout;
+
+const uint32_t MATRIX_FLOATS = 16;
+const uint32_t COLOR_STREAM  = MATRIX_FLOATS;  // first of the 3 color streams
+const uint32_t NUM_STREAMS   = MATRIX_FLOATS + 3;
+const size_t   STREAM_ALIGN  = 8;  // widest kernel
+
+inline void storeFloats(uint8_t* record, size_t offset, const float* values, size_t count)
+{
+  if(offset != BatchTransform::NO_OUTPUT)
+  {
+    memcpy(record + offset, values, count * sizeof(float));
+  }
+}
+
+// the values which don't depend on the camera: the colors and the object indices
+inline void storeObjectConstants(const float*        streams,
+                                 size_t              streamSize,
+                                 uint32_t            first,
+                                 uint32_t            count,
+                                 const OutputLayout& layout,
+                                 uint8_t*            output)
+{
+  for(uint32_t o = first; o < first + count; ++o)
+  {
+    uint8_t* record = output + o * layout.stride;
+    if(layout.color != BatchTransform::NO_OUTPUT)
+    {
+      float color[3] = {streams[(COLOR_STREAM + 0) * streamSize + o], streams[(COLOR_STREAM + 1) * streamSize + o],
+                        streams[(COLOR_STREAM + 2) * streamSize + o]};
+      storeFloats(record, layout.color, color, 3);
+    }
+    if(layout.index != BatchTransform::NO_OUTPUT)
+    {
+      const int32_t index = int32_t(o);
+      memcpy(record + layout.index, &index, sizeof(index));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// scalar
+
+void transformGLM(const float*        streams,
+                  size_t              streamSize,
+                  uint32_t            first,
+                  uint32_t            count,
+                  const glm::mat4&    view,
+                  const glm::mat4&    projection,
+                  const OutputLayout& layout,
+                  uint8_t*            output)
+{
+  // same math as Pipeline::updateObjectData()
+  for(uint32_t o = first; o < first + count; ++o)
+  {
+    glm::mat4 model;
+    for(uint32_t k = 0; k < MATRIX_FLOATS; ++k)
+    {
+      model[k / 4][k % 4] = streams[k * streamSize + o];
+    }
+    glm::mat4 modelView     = view * model;
+    glm::mat4 modelViewIT   = glm::transpose(glm::inverse(modelView));
+    glm::mat4 modelViewProj = projection * view * model;
+
+    uint8_t* record = output + o * layout.stride;
+    storeFloats(record, layout.model, &model[0][0], MATRIX_FLOATS);
+    storeFloats(record, layout.modelView, &modelView[0][0], MATRIX_FLOATS);
+    storeFloats(record, layout.modelViewIT, &modelViewIT[0][0], MATRIX_FLOATS);
+    storeFloats(record, layout.modelViewProj, &modelViewProj[0][0], MATRIX_FLOATS);
+  }
+  storeObjectConstants(streams, streamSize, first, count, layout, output);
+}
+
+void transformScalar(const float*        streams,
+                     size_t              streamSize,
+                     uint32_t            first,
+                     uint32_t            count,
+                     const glm::mat4&    view,
+                     const glm::mat4&    viewProj,
+                     const OutputLayout& layout,
+                     uint8_t*            output)
+{
+  for(uint32_t o = first; o < first + count; ++o)
+  {
+    float m[16], mv[16], mvp[16], it[16];
+    for(uint32_t k = 0; k < MATRIX_FLOATS; ++k)
+    {
+      m[k] = streams[k * streamSize + o];
+    }
+    for(int c = 0; c < 4; ++c)
+    {
+      for(int r = 0; r < 4; ++r)
+      {
+        mv[c * 4 + r] = view[0][r] * m[c * 4 + 0] + view[1][r] * m[c * 4 + 1] + view[2][r] * m[c * 4 + 2] + view[3][r] * m[c * 4 + 3];
+        mvp[c * 4 + r] = viewProj[0][r] * m[c * 4 + 0] + viewProj[1][r] * m[c * 4 + 1] + viewProj[2][r] * m[c * 4 + 2]
+                         + viewProj[3][r] * m[c * 4 + 3];
+      }
+    }
+
+    // modelView = [s*R t], its inverse transpose is [R/s 0; -(R^T t)/s 1] with R/s = s*R / s^2
+    float invScale2 = 1.0f / (mv[0] * mv[0] + mv[1] * mv[1] + mv[2] * mv[2]);
+    for(int c = 0; c < 3; ++c)
+    {
+      for(int r = 0; r < 3; ++r)
+      {
+        it[c * 4 + r] = mv[c * 4 + r] * invScale2;
+      }
+      it[c * 4 + 3] = -(mv[c * 4 + 0] * mv[12] + mv[c * 4 + 1] * mv[13] + mv[c * 4 + 2] * mv[14]) * invScale2;
+    }
+    it[12] = it[13] = it[14] = 0.0f;
+    it[15]                   = 1.0f;
+
+    uint8_t* record = output + o * layout.stride;
+    storeFloats(record, layout.model, m, MATRIX_FLOATS);
+    storeFloats(record, layout.modelView, mv, MATRIX_FLOATS);
+    storeFloats(record, layout.modelViewIT, it, MATRIX_FLOATS);
+    storeFloats(record, layout.modelViewProj, mvp, MATRIX_FLOATS);
+  }
+  storeObjectConstants(streams, streamSize, first, count, layout, output);
+}
+
+#if BATCH_TRANSFORM_X86
+
+//////////////////////////////////////////////////////////////////////////
+// SSE, 4 objects per iteration
+//
+// The matrices are produced and stored one column at a time to keep the
+// working set within the vector registers.
+
+// stores column c of the matrices of 4 objects, row r of all objects is in r0..r3
+inline void storeColumnSSE(__m128 r0, __m128 r1, __m128 r2, __m128 r3, uint8_t* record, size_t stride, size_t offset, int c)
+{
+  if(offset == BatchTransform::NO_OUTPUT)
+  {
+    return;
+  }
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  _mm_storeu_ps((float*)(record + 0 * stride + offset) + c * 4, r0);
+  _mm_storeu_ps((float*)(record + 1 * stride + offset) + c * 4, r1);
+  _mm_storeu_ps((float*)(record + 2 * stride + offset) + c * 4, r2);
+  _mm_storeu_ps((float*)(record + 3 * stride + offset) + c * 4, r3);
+}
+
+// row r of column c of a * m, with m given as its 16 element streams
+inline __m128 mulColumnRowSSE(const glm::mat4& a, const __m128 m[16], int c, int r)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0][r]), m[c * 4 + 0]), _mm_mul_ps(_mm_set1_ps(a[1][r]), m[c * 4 + 1])),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2][r]), m[c * 4 + 2]), _mm_mul_ps(_mm_set1_ps(a[3][r]), m[c * 4 + 3])));
+}
+
+void transformSSE(const float*        streams,
+                  size_t              streamSize,
+                  uint32_t            first,
+                  uint32_t            count,
+                  const glm::mat4&    view,
+                  const glm::mat4&    viewProj,
+                  const OutputLayout& layout,
+                  uint8_t*            output)
+{
+  const uint32_t end = first + count;
+  uint32_t       o   = first;
+  for(; o + 4 <= end; o += 4)
+  {
+    __m128 m[16];
+    for(uint32_t k = 0; k < MATRIX_FLOATS; ++k)
+    {
+      m[k] = _mm_loadu_ps(streams + k * streamSize + o);
+    }
+
+    // translation of modelView and the squared scale, see transformScalar()
+    __m128 t0 = mulColumnRowSSE(view, m, 3, 0);
+    __m128 t1 = mulColumnRowSSE(view, m, 3, 1);
+    __m128 t2 = mulColumnRowSSE(view, m, 3, 2);
+    __m128 invScale2 = _mm_setzero_ps();  // set for c == 0 below
+
+    uint8_t* record = output + o * layout.stride;
+    for(int c = 0; c < 4; ++c)
+    {
+      __m128 mv0 = mulColumnRowSSE(view, m, c, 0);
+      __m128 mv1 = mulColumnRowSSE(view, m, c, 1);
+      __m128 mv2 = mulColumnRowSSE(view, m, c, 2);
+      __m128 mv3 = mulColumnRowSSE(view, m, c, 3);
+      storeColumnSSE(m[c * 4 + 0], m[c * 4 + 1], m[c * 4 + 2], m[c * 4 + 3], record, layout.stride, layout.model, c);
+      storeColumnSSE(mv0, mv1, mv2, mv3, record, layout.stride, layout.modelView, c);
+      storeColumnSSE(mulColumnRowSSE(viewProj, m, c, 0), mulColumnRowSSE(viewProj, m, c, 1), mulColumnRowSSE(viewProj, m, c, 2),
+                     mulColumnRowSSE(viewProj, m, c, 3), record, layout.stride, layout.modelViewProj, c);
+
+      if(c == 0)
+      {
+        __m128 scale2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mv0, mv0), _mm_mul_ps(mv1, mv1)), _mm_mul_ps(mv2, mv2));
+        invScale2     = _mm_div_ps(_mm_set1_ps(1.0f), scale2);
+      }
+      if(c < 3)
+      {
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mv0, t0), _mm_mul_ps(mv1, t1)), _mm_mul_ps(mv2, t2));
+        storeColumnSSE(_mm_mul_ps(mv0, invScale2), _mm_mul_ps(mv1, invScale2), _mm_mul_ps(mv2, invScale2),
+                       _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(dot, invScale2)), record, layout.stride, layout.modelViewIT, c);
+      }
+      else
+      {
+        storeColumnSSE(_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_set1_ps(1.0f), record, layout.stride,
+                       layout.modelViewIT, c);
+      }
+    }
+  }
+  storeObjectConstants(streams, streamSize, first, o - first, layout, output);
+
+  // remaining objects
+  transformScalar(streams, streamSize, o, end - o, view, viewProj, layout, output);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2, 8 objects per iteration, same structure as transformSSE()
+
+BATCH_TRANSFORM_AVX2_TARGET inline void storeColumnAVX2(__m256 r0, __m256 r1, __m256 r2, __m256 r3, uint8_t* record, size_t stride, size_t offset, int c)
+{
+  if(offset == BatchTransform::NO_OUTPUT)
+  {
+    return;
+  }
+  // objects 0..3 are in the lower, 4..7 in the upper halves
+  storeColumnSSE(_mm256_castps256_ps128(r0), _mm256_castps256_ps128(r1), _mm256_castps256_ps128(r2),
+                 _mm256_castps256_ps128(r3), record, stride, offset, c);
+  storeColumnSSE(_mm256_extractf128_ps(r0, 1), _mm256_extractf128_ps(r1, 1), _mm256_extractf128_ps(r2, 1),
+                 _mm256_extractf128_ps(r3, 1), record + 4 * stride, stride, offset, c);
+}
+
+BATCH_TRANSFORM_AVX2_TARGET inline __m256 mulColumnRowAVX2(const glm::mat4& a, const __m256 m[16], int c, int r)
+{
+  __m256 sum = _mm256_mul_ps(_mm256_set1_ps(a[0][r]), m[c * 4 + 0]);
+  sum        = _mm256_fmadd_ps(_mm256_set1_ps(a[1][r]), m[c * 4 + 1], sum);
+  sum        = _mm256_fmadd_ps(_mm256_set1_ps(a[2][r]), m[c * 4 + 2], sum);
+  return _mm256_fmadd_ps(_mm256_set1_ps(a[3][r]), m[c * 4 + 3], sum);
+}
+
+BATCH_TRANSFORM_AVX2_TARGET void transformAVX2(const float*        streams,
+                                               size_t              streamSize,
+                                               uint32_t            first,
+                                               uint32_t            count,
+                                               const glm::mat4&    view,
+                                               const glm::mat4&    viewProj,
+                                               const OutputLayout& layout,
+                                               uint8_t*            output)
+{
+  const uint32_t end = first + count;
+  uint32_t       o   = first;
+  for(; o + 8 <= end; o += 8)
+  {
+    __m256 m[16];
+    for(uint32_t k = 0; k < MATRIX_FLOATS; ++k)
+    {
+      m[k] = _mm256_loadu_ps(streams + k * streamSize + o);
+    }
+
+    __m256 t0 = mulColumnRowAVX2(view, m, 3, 0);
+    __m256 t1 = mulColumnRowAVX2(view, m, 3, 1);
+    __m256 t2 = mulColumnRowAVX2(view, m, 3, 2);
+    __m256 invScale2 = _mm256_setzero_ps();  // set for c == 0 below
+
+    uint8_t* record = output + o * layout.stride;
+    for(int c = 0; c < 4; ++c)
+    {
+      __m256 mv0 = mulColumnRowAVX2(view, m, c, 0);
+      __m256 mv1 = mulColumnRowAVX2(view, m, c, 1);
+      __m256 mv2 = mulColumnRowAVX2(view, m, c, 2);
+      __m256 mv3 = mulColumnRowAVX2(view, m, c, 3);
+      storeColumnAVX2(m[c * 4 + 0], m[c * 4 + 1], m[c * 4 + 2], m[c * 4 + 3], record, layout.stride, layout.model, c);
+      storeColumnAVX2(mv0, mv1, mv2, mv3, record, layout.stride, layout.modelView, c);
+      storeColumnAVX2(mulColumnRowAVX2(viewProj, m, c, 0), mulColumnRowAVX2(viewProj, m, c, 1),
+                      mulColumnRowAVX2(viewProj, m, c, 2), mulColumnRowAVX2(viewProj, m, c, 3), record, layout.stride,
+                      layout.modelViewProj, c);
+
+      if(c == 0)
+      {
+        __m256 scale2 = _mm256_mul_ps(mv0, mv0);
+        scale2        = _mm256_fmadd_ps(mv1, mv1, scale2);
+        scale2        = _mm256_fmadd_ps(mv2, mv2, scale2);
+        invScale2     = _mm256_div_ps(_mm256_set1_ps(1.0f), scale2);
+      }
+      if(c < 3)
+      {
+        __m256 dot = _mm256_mul_ps(mv0, t0);
+        dot        = _mm256_fmadd_ps(mv1, t1, dot);
+        dot        = _mm256_fmadd_ps(mv2, t2, dot);
+        storeColumnAVX2(_mm256_mul_ps(mv0, invScale2), _mm256_mul_ps(mv1, invScale2), _mm256_mul_ps(mv2, invScale2),
+                        _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(dot, invScale2)), record, layout.stride,
+                        layout.modelViewIT, c);
+      }
+      else
+      {
+        storeColumnAVX2(_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_set1_ps(1.0f), record,
+                        layout.stride, layout.modelViewIT, c);
+      }
+    }
+  }
+  storeObjectConstants(streams, streamSize, first, o - first, layout, output);
+
+  // remaining objects
+  transformSSE(streams, streamSize, o, end - o, view, viewProj, layout, output);
+}
+
+bool cpuSupportsAVX2()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if(info[0] < 7)
+  {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool fma     = (info[2] & (1 << 12)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  // the OS has to save the ymm registers
+  if(!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+  {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif  // BATCH_TRANSFORM_X86
+
+}  // namespace
+
+bool BatchTransform::isSupported(Kernel kernel)
+{
+  switch(kernel)
+  {
+    case Kernel::GLM:
+    case Kernel::SCALAR:
+      return true;
+#if BATCH_TRANSFORM_X86
+    case Kernel::SSE:
+      return true;
+    case Kernel::AVX2: {
+      static const bool avx2 = cpuSupportsAVX2();
+      return avx2;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+BatchTransform::Kernel BatchTransform::getBestKernel()
+{
+  if(isSupported(Kernel::AVX2))
+    return Kernel::AVX2;
+  if(isSupported(Kernel::SSE))
+    return Kernel::SSE;
+  return Kernel::SCALAR;
+}
+
+const char* BatchTransform::getKernelName(Kernel kernel)
+{
+  switch(kernel)
+  {
+    case Kernel::GLM:
+      return "glm";
+    case Kernel::SCALAR:
+      return "scalar";
+    case Kernel::SSE:
+      return "sse";
+    case Kernel::AVX2:
+      return "avx2";
+    default:
+      return "unknown";
+  }
+}
+
+void BatchTransform::setObjects(const glm::mat4* models, const glm::vec3* colors, uint32_t count)
+{
+  m_count      = count;
+  m_streamSize = ((count + STREAM_ALIGN - 1) / STREAM_ALIGN) * STREAM_ALIGN;
+  m_streams.assign(NUM_STREAMS * m_streamSize, 0.0f);
+
+  for(uint32_t o = 0; o < count; ++o)
+  {
+    for(uint32_t k = 0; k < MATRIX_FLOATS; ++k)
+    {
+      m_streams[k * m_streamSize + o] = models[o][k / 4][k % 4];
+    }
+    if(colors)
+    {
+      for(uint32_t k = 0; k < 3; ++k)
+      {
+        m_streams[(COLOR_STREAM + k) * m_streamSize + o] = colors[o][k];
+      }
+    }
+  }
+}
+
+void BatchTransform::transform(Kernel              kernel,
+                               const glm::mat4&    view,
+                               const glm::mat4&    projection,
+                               const OutputLayout& layout,
+                               uint8_t*            output,
+                               uint32_t            first,
+                               uint32_t            count) const
+{
+  if(first >= m_count)
+  {
+    return;
+  }
+  count = std::min(count, m_count - first);
+
+  if(!isSupported(kernel))
+  {
+    kernel = getBestKernel();
+  }
+
+  const float*    streams  = m_streams.data();
+  const glm::mat4 viewProj = projection * view;
+  switch(kernel)
+  {
+    case Kernel::GLM:
+      transformGLM(streams, m_streamSize, first, count, view, projection, layout, output);
+      break;
+#if BATCH_TRANSFORM_X86
+    case Kernel::SSE:
+      transformSSE(streams, m_streamSize, first, count, view, viewProj, layout, output);
+      break;
+    case Kernel::AVX2:
+      transformAVX2(streams, m_streamSize, first, count, view, viewProj, layout, output);
+      break;
+#endif
+    default:
+      transformScalar(streams, m_streamSize, first, count, view, viewProj, layout, output);
+      break;
+  }
+}
+
+void BatchTransform::runMicrobenchmark(uint32_t numObjects, uint32_t iterations)
+{
+  struct Record
+  {
+    glm::mat4 model;
+    glm::mat4 modelView;
+    glm::mat4 modelViewIT;
+    glm::mat4 modelViewProj;
+    glm::vec3 color;
+  };
+  OutputLayout layout;
+  layout.stride        = sizeof(Record);
+  layout.model         = offsetof(Record, model);
+  layout.modelView     = offsetof(Record, modelView);
+  layout.modelViewIT   = offsetof(Record, modelViewIT);
+  layout.modelViewProj = offsetof(Record, modelViewProj);
+  layout.color         = offsetof(Record, color);
+
+  // tori like transforms: uniform scale, translation, rotation
+  std::vector<glm::mat4> models(numObjects);
+  std::vector<glm::vec3> colors(numObjects, glm::vec3(0, .7f, 1));
+  for(uint32_t i = 0; i < numObjects; ++i)
+  {
+    float x   = float(i % 64) - 32.0f;
+    float y   = float(i / 64) * 1.5f;
+    models[i] = glm::scale(glm::mat4(1.0f), glm::vec3(0.05f)) * glm::translate(glm::mat4(1.f), glm::vec3(x, y, 0.0f))
+                * glm::rotate(glm::mat4(1.f), (i % 2 ? -1.0f : 1.0f) * glm::pi<float>() / 4.0f, glm::vec3(1, 0, 0));
+  }
+  const glm::mat4 view       = glm::lookAt(glm::vec3(0.3f, 0.2f, 2.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+  const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+  BatchTransform batch;
+  batch.setObjects(models.data(), colors.data(), numObjects);
+
+  std::vector<Record> reference(numObjects);
+  std::vector<Record> result(numObjects);
+  batch.transform(Kernel::GLM, view, projection, layout, (uint8_t*)reference.data());
+
+  LOGI("transform microbenchmark: %u objects, %u iterations\n", numObjects, iterations);
+  for(int k = 0; k < int(Kernel::NUM_KERNELS); ++k)
+  {
+    Kernel kernel = Kernel(k);
+    if(!isSupported(kernel))
+    {
+      LOGI("  %-6s not supported\n", getKernelName(kernel));
+      continue;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < iterations; ++i)
+    {
+      batch.transform(kernel, view, projection, layout, (uint8_t*)result.data());
+    }
+    std::chrono::duration<double, std::nano> duration = std::chrono::high_resolution_clock::now() - start;
+
+    // largest deviation from the glm reference, over all matrix elements
+    float maxError = 0.0f;
+    for(uint32_t o = 0; o < numObjects; ++o)
+    {
+      const float* a = &reference[o].model[0][0];
+      const float* b = &result[o].model[0][0];
+      for(uint32_t f = 0; f < 4 * MATRIX_FLOATS; ++f)
+      {
+        maxError = std::max(maxError, std::abs(a[f] - b[f]));
+      }
+    }
+
+    LOGI("  %-6s %8.2f ns/object, max error %g\n", getKernelName(kernel),
+         duration.count() / (double(iterations) * std::max(numObjects, 1u)), maxError);
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Computes the per object matrices (model, modelView, modelViewIT, modelViewProj) of many objects at once.
+///        The model matrices are kept as structure of arrays so SSE and AVX2 can process 4 or 8 objects per
+///        instruction, the results are written as array of structures directly into the object data.
+///        The model matrices must be affine with a uniform scale (no shearing, as assumed in mvr_scene.vert.glsl),
+///        this allows deriving the normal matrix from modelView instead of a general inverse.
+class BatchTransform
+{
+public:
+  enum class Kernel
+  {
+    GLM,     // scalar glm, general inverse: the reference
+    SCALAR,  // scalar, no shearing normal matrix
+    SSE,     // 4 objects at a time
+    AVX2,    // 8 objects at a time
+    NUM_KERNELS
+  };
+
+  /// @brief Where the results go within one output record, NO_OUTPUT skips a field.
+  struct OutputLayout
+  {
+    size_t stride        = 0;
+    size_t model         = NO_OUTPUT;
+    size_t modelView     = NO_OUTPUT;
+    size_t modelViewIT   = NO_OUTPUT;
+    size_t modelViewProj = NO_OUTPUT;
+    size_t color         = NO_OUTPUT;  // glm::vec3
+    size_t index         = NO_OUTPUT;  // int32_t, the index of the object
+  };
+  static const size_t NO_OUTPUT = ~size_t(0);
+
+  static bool        isSupported(Kernel kernel);
+  static Kernel      getBestKernel();
+  static const char* getKernelName(Kernel kernel);
+
+  /// @brief Copies the model matrices and colors (may be nullptr) into the SoA storage.
+  void     setObjects(const glm::mat4* models, const glm::vec3* colors, uint32_t count);
+  uint32_t getCount() const { return m_count; }
+
+  /// @brief Writes objects [first, first + count) into output, output points at the record of object 0.
+  void transform(Kernel              kernel,
+                 const glm::mat4&    view,
+                 const glm::mat4&    projection,
+                 const OutputLayout& layout,
+                 uint8_t*            output,
+                 uint32_t            first = 0,
+                 uint32_t            count = ~0u) const;
+
+  /// @brief Times all supported kernels against the glm reference and logs the results.
+  static void runMicrobenchmark(uint32_t numObjects, uint32_t iterations);
+
+private:
+  // 16 model matrix streams (column major element order) followed by 3 color streams,
+  // each m_streamSize floats long
+  std::vector<float> m_streams;
+  size_t             m_streamSize = 0;
+  uint32_t           m_count      = 0;
+};
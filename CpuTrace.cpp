@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "CpuTrace.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+std::atomic<bool> CpuTrace::s_enabled{false};
+
+namespace {
+
+struct Event
+{
+  // index + 1 of the write which completed this slot, 0 while it is written, so the export skips torn events
+  std::atomic<uint64_t> sequence{0};
+  const char*           name   = nullptr;
+  uint64_t              begin  = 0;
+  uint64_t              end    = 0;
+  uint32_t              thread = 0;
+};
+
+struct ThreadName
+{
+  uint32_t    thread;
+  std::string name;
+};
+
+std::unique_ptr<Event[]> s_events;
+std::atomic<uint64_t>    s_nextEvent{0};
+std::atomic<uint32_t>    s_nextThread{0};
+
+// only touched by setEnabled(), setThreadName() and the export
+std::mutex s_mutex;
+// by OS thread, so the threads of a re-initialized WorkerPool replace the entries of the previous ones
+// once their IDs get reused instead of adding more and more entries
+std::map<std::thread::id, ThreadName> s_threadNames;
+
+const auto s_start = std::chrono::steady_clock::now();
+
+uint32_t getThreadIndex()
+{
+  // small consecutive IDs read better in the trace viewers than the OS thread IDs
+  thread_local uint32_t index = s_nextThread.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+}  // namespace
+
+void CpuTrace::setEnabled(bool enabled)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  if(enabled && !s_events)
+  {
+    s_events = std::make_unique<Event[]>(CAPACITY);
+  }
+  // release: threads seeing enabled also see the ring
+  s_enabled.store(enabled, std::memory_order_release);
+}
+
+void CpuTrace::setThreadName(const char* name)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_threadNames[std::this_thread::get_id()] = {getThreadIndex(), name};
+}
+
+uint64_t CpuTrace::now()
+{
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_start).count());
+}
+
+void CpuTrace::record(const char* name, uint64_t begin, uint64_t end)
+{
+  const uint64_t index = s_nextEvent.fetch_add(1, std::memory_order_relaxed);
+  Event&         event = s_events[index % CAPACITY];
+  event.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.name   = name;
+  event.begin  = begin;
+  event.end    = end;
+  event.thread = getThreadIndex();
+  event.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool CpuTrace::writeChromeTrace(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  if(!s_events)
+  {
+    LOGW("No CPU trace recorded, enable it first\n");
+    return false;
+  }
+
+  FILE* file = fopen(filename.c_str(), "wt");
+  if(!file)
+  {
+    LOGE("Can't write the CPU trace %s\n", filename.c_str());
+    return false;
+  }
+
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  bool first = true;
+  for(const auto& entry : s_threadNames)
+  {
+    const ThreadName& threadName = entry.second;
+    fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+            first ? "" : ",\n", threadName.thread, threadName.name.c_str());
+    first = false;
+  }
+
+  // the events still in the ring, oldest first
+  const uint64_t next   = s_nextEvent.load(std::memory_order_acquire);
+  const uint64_t oldest = next > CAPACITY ? next - CAPACITY : 0;
+  uint32_t       count  = 0;
+  for(uint64_t index = oldest; index < next; ++index)
+  {
+    const Event& slot = s_events[index % CAPACITY];
+    if(slot.sequence.load(std::memory_order_acquire) != index + 1)
+    {
+      // overwritten or still being written
+      continue;
+    }
+    Event event;
+    event.name   = slot.name;
+    event.begin  = slot.begin;
+    event.end    = slot.end;
+    event.thread = slot.thread;
+    // a writer may have started on the slot during the copy
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(slot.sequence.load(std::memory_order_relaxed) != index + 1)
+    {
+      continue;
+    }
+    // complete events, times in microseconds
+    fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+            first ? "" : ",\n", event.name, event.thread, double(event.begin) / 1000.0,
+            double(event.end - event.begin) / 1000.0);
+    first = false;
+    ++count;
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+
+  LOGI("Wrote %u CPU zones to %s\n", count, filename.c_str());
+  return true;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// @brief Records scoped CPU zones (name, thread, begin and end time) into a fixed in-memory ring, lock-free,
+///        so zones can be recorded from worker threads as well. writeChromeTrace() exports the ring as
+///        Chrome trace JSON (chrome://tracing, Perfetto). While disabled a zone costs a single branch.
+///        Zone names have to stay valid until the export, e.g. string literals.
+class CpuTrace
+{
+public:
+  static const uint32_t CAPACITY = 1 << 16;  // events, the oldest ones get overwritten
+
+  // acquire: pairs with setEnabled(), the ring exists once this returns true
+  static bool isEnabled() { return s_enabled.load(std::memory_order_acquire); }
+  /// @brief Allocates the ring when enabled the first time.
+  static void setEnabled(bool enabled);
+
+  /// @brief Names the calling thread in the export.
+  static void setThreadName(const char* name);
+
+  /// @brief Writes the recorded zones, returns false if the file can't be written.
+  static bool writeChromeTrace(const std::string& filename);
+
+  static uint64_t now();
+  static void     record(const char* name, uint64_t begin, uint64_t end);
+
+  class Zone
+  {
+  public:
+    explicit Zone(const char* name)
+    {
+      if(isEnabled())
+      {
+        m_name  = name;
+        m_begin = now();
+      }
+    }
+    ~Zone()
+    {
+      if(m_name)
+      {
+        record(m_name, m_begin, now());
+      }
+    }
+
+  private:
+    const char* m_name  = nullptr;
+    uint64_t    m_begin = 0;
+  };
+
+private:
+  static std::atomic<bool> s_enabled;
+};
+
+#define CPU_TRACE_CONCAT_(a, b) a##b
+#define CPU_TRACE_CONCAT(a, b) CPU_TRACE_CONCAT_(a, b)
+/// @brief Records the rest of the enclosing scope as zone 'name'.
+#define CPU_TRACE_ZONE(name) CpuTrace::Zone CPU_TRACE_CONCAT(cpuTraceZone, __LINE__)(name)
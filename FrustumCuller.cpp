@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "FrustumCuller.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FRUSTUM_CULLER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+// MSVC allows AVX2 intrinsics without enabling them for the whole file
+#define FRUSTUM_CULLER_AVX2_TARGET
+#else
+#define FRUSTUM_CULLER_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#else
+#define FRUSTUM_CULLER_X86 0
+#endif
+
+namespace {
+
+const size_t STREAM_ALIGN = 8;  // widest kernel
+
+using Planes = glm::vec4[6];
+
+void cullScalar(const float* streams, size_t streamSize, const Planes* planes, uint32_t numViews, uint8_t* masks, uint32_t first, uint32_t count)
+{
+  const float* x = streams;
+  const float* y = streams + streamSize;
+  const float* z = streams + 2 * streamSize;
+  const float* r = streams + 3 * streamSize;
+
+  for(uint32_t o = first; o < first + count; ++o)
+  {
+    uint8_t mask = 0;
+    for(uint32_t v = 0; v < numViews; ++v)
+    {
+      bool inside = true;
+      for(uint32_t p = 0; p < 6 && inside; ++p)
+      {
+        const glm::vec4& plane = planes[v][p];
+        inside = plane.x * x[o] + plane.y * y[o] + plane.z * z[o] + plane.w + r[o] >= 0.0f;
+      }
+      mask |= inside ? uint8_t(1 << v) : 0;
+    }
+    masks[o] = mask;
+  }
+}
+
+#if FRUSTUM_CULLER_X86
+
+//////////////////////////////////////////////////////////////////////////
+// SSE, 4 spheres per iteration
+
+void cullSSE(const float* streams, size_t streamSize, const Planes* planes, uint32_t numViews, uint8_t* masks, uint32_t first, uint32_t count)
+{
+  const uint32_t end = first + count;
+  uint32_t       o   = first;
+  for(; o + 4 <= end; o += 4)
+  {
+    const __m128 x = _mm_loadu_ps(streams + o);
+    const __m128 y = _mm_loadu_ps(streams + streamSize + o);
+    const __m128 z = _mm_loadu_ps(streams + 2 * streamSize + o);
+    const __m128 r = _mm_loadu_ps(streams + 3 * streamSize + o);
+
+    int viewBits[8];  // movemask of each view, bit k for sphere o + k
+    for(uint32_t v = 0; v < numViews; ++v)
+    {
+      __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      for(uint32_t p = 0; p < 6; ++p)
+      {
+        const glm::vec4& plane = planes[v][p];
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_add_ps(_mm_set1_ps(plane.w), r)));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+      }
+      viewBits[v] = _mm_movemask_ps(inside);
+    }
+
+    for(uint32_t k = 0; k < 4; ++k)
+    {
+      uint8_t mask = 0;
+      for(uint32_t v = 0; v < numViews; ++v)
+      {
+        mask |= uint8_t(((viewBits[v] >> k) & 1) << v);
+      }
+      masks[o + k] = mask;
+    }
+  }
+
+  // remaining spheres
+  cullScalar(streams, streamSize, planes, numViews, masks, o, end - o);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2, 8 spheres per iteration
+
+FRUSTUM_CULLER_AVX2_TARGET void cullAVX2(const float*  streams,
+                                         size_t        streamSize,
+                                         const Planes* planes,
+                                         uint32_t      numViews,
+                                         uint8_t*      masks,
+                                         uint32_t      first,
+                                         uint32_t      count)
+{
+  const uint32_t end = first + count;
+  uint32_t       o   = first;
+  for(; o + 8 <= end; o += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(streams + o);
+    const __m256 y = _mm256_loadu_ps(streams + streamSize + o);
+    const __m256 z = _mm256_loadu_ps(streams + 2 * streamSize + o);
+    const __m256 r = _mm256_loadu_ps(streams + 3 * streamSize + o);
+
+    // bit v of each lane is set if the sphere is inside view v
+    __m256i laneMasks = _mm256_setzero_si256();
+    for(uint32_t v = 0; v < numViews; ++v)
+    {
+      __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+      for(uint32_t p = 0; p < 6; ++p)
+      {
+        const glm::vec4& plane    = planes[v][p];
+        __m256           distance = _mm256_add_ps(_mm256_set1_ps(plane.w), r);
+        distance                  = _mm256_fmadd_ps(_mm256_set1_ps(plane.x), x, distance);
+        distance                  = _mm256_fmadd_ps(_mm256_set1_ps(plane.y), y, distance);
+        distance                  = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), z, distance);
+        inside                    = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+      }
+      laneMasks = _mm256_or_si256(laneMasks, _mm256_and_si256(_mm256_castps_si256(inside), _mm256_set1_epi32(1 << v)));
+    }
+
+    // narrow the 32 bit lanes to bytes
+    __m128i masks16 = _mm_packus_epi32(_mm256_castsi256_si128(laneMasks), _mm256_extracti128_si256(laneMasks, 1));
+    __m128i masks8  = _mm_packus_epi16(masks16, masks16);
+    _mm_storel_epi64((__m128i*)(masks + o), masks8);
+  }
+
+  // remaining spheres
+  cullScalar(streams, streamSize, planes, numViews, masks, o, end - o);
+}
+
+#endif  // FRUSTUM_CULLER_X86
+
+}  // namespace
+
+void FrustumCuller::setSpheres(const glm::vec4* spheres, uint32_t count)
+{
+  m_count      = count;
+  m_streamSize = ((count + STREAM_ALIGN - 1) / STREAM_ALIGN) * STREAM_ALIGN;
+  m_streams.assign(4 * m_streamSize, 0.0f);
+
+  for(uint32_t o = 0; o < count; ++o)
+  {
+    for(uint32_t k = 0; k < 4; ++k)
+    {
+      m_streams[k * m_streamSize + o] = spheres[o][k];
+    }
+  }
+}
+
+void FrustumCuller::setViews(const glm::mat4* viewProjections, uint32_t numViews)
+{
+  m_numViews = numViews < MAX_CULL_VIEWS ? numViews : MAX_CULL_VIEWS;
+  for(uint32_t v = 0; v < m_numViews; ++v)
+  {
+    // Gribb/Hartmann: the planes are the sums and differences of the last row with the others
+    const glm::mat4& m = viewProjections[v];
+    glm::vec4        rows[4];
+    for(int r = 0; r < 4; ++r)
+    {
+      rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+    }
+    for(int p = 0; p < 6; ++p)
+    {
+      glm::vec4 plane = (p % 2 == 0) ? rows[3] + rows[p / 2] : rows[3] - rows[p / 2];
+      // normalized, so the signed distance can be compared against the radius
+      plane          = plane / glm::length(glm::vec3(plane));
+      m_planes[v][p] = plane;
+    }
+  }
+}
+
+void FrustumCuller::cull(BatchTransform::Kernel kernel, uint8_t* masks, uint32_t first, uint32_t count) const
+{
+  if(first >= m_count)
+  {
+    return;
+  }
+  count = std::min(count, m_count - first);
+
+  if(!BatchTransform::isSupported(kernel))
+  {
+    kernel = BatchTransform::getBestKernel();
+  }
+
+  const float* streams = m_streams.data();
+  switch(kernel)
+  {
+#if FRUSTUM_CULLER_X86
+    case BatchTransform::Kernel::SSE:
+      cullSSE(streams, m_streamSize, m_planes, m_numViews, masks, first, count);
+      break;
+    case BatchTransform::Kernel::AVX2:
+      cullAVX2(streams, m_streamSize, m_planes, m_numViews, masks, first, count);
+      break;
+#endif
+    default:
+      cullScalar(streams, m_streamSize, m_planes, m_numViews, masks, first, count);
+      break;
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "BatchTransform.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Where the tori get culled against the view frusta
+enum class CullingMode
+{
+  DISABLED,
+  CPU,  // FrustumCuller view masks, all draw paths
+  GPU,  // GpuCuller compute pass writing the indirect commands, multi draw indirect only (else CPU)
+};
+
+/// @brief Tests the bounding spheres of many objects against the frusta of up to MAX_CULL_VIEWS views at once.
+///        The spheres are kept as structure of arrays, the SSE and AVX2 kernels (selected like the ones of
+///        BatchTransform) test 4 or 8 spheres against all planes of all views per iteration.
+///        The result is one mask per object, bit v set if the sphere intersects the frustum of view v.
+class FrustumCuller
+{
+public:
+  static const uint32_t MAX_CULL_VIEWS = 8;
+
+  /// @brief Copies the spheres (xyz: world space center, w: radius) into the SoA storage.
+  void     setSpheres(const glm::vec4* spheres, uint32_t count);
+  uint32_t getCount() const { return m_count; }
+
+  /// @brief Extracts the normalized frustum planes from the view projection matrices (OpenGL clip space).
+  void     setViews(const glm::mat4* viewProjections, uint32_t numViews);
+  uint32_t getNumViews() const { return m_numViews; }
+
+  /// @brief Writes the view masks of objects [first, first + count) into masks, masks points at the mask of object 0.
+  void cull(BatchTransform::Kernel kernel, uint8_t* masks, uint32_t first = 0, uint32_t count = ~0u) const;
+
+private:
+  // x, y, z and radius streams, each m_streamSize floats long
+  std::vector<float> m_streams;
+  size_t             m_streamSize = 0;
+  uint32_t           m_count      = 0;
+
+  // 6 planes per view: left, right, bottom, top, near, far
+  glm::vec4 m_planes[MAX_CULL_VIEWS][6];
+  uint32_t  m_numViews = 0;
+};
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "GLStateCache.h"
+
+namespace {
+const GLuint UNKNOWN = ~0u;
+}
+
+GLStateCache& GLStateCache::get()
+{
+  // the sample uses a single context
+  static GLStateCache cache;
+  return cache;
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+  if(update(m_program, program))
+  {
+    glUseProgram(program);
+  }
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+  if(update(m_vao, vao))
+  {
+    glBindVertexArray(vao);
+  }
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+  GLuint* current = nullptr;
+  if(target == GL_DRAW_INDIRECT_BUFFER)
+  {
+    current = &m_drawIndirectBuffer;
+  }
+  else if(target == GL_PARAMETER_BUFFER_ARB)
+  {
+    current = &m_parameterBuffer;
+  }
+
+  if(!current)
+  {
+    ++m_counters.issued;
+    glBindBuffer(target, buffer);
+  }
+  else if(update(*current, buffer))
+  {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+  IndexedBinding  binding{buffer, 0, 0, true};
+  IndexedBinding* current = getIndexedBinding(target, index);
+  if(!current)
+  {
+    ++m_counters.issued;
+    glBindBufferBase(target, index, buffer);
+  }
+  else if(update(*current, binding))
+  {
+    glBindBufferBase(target, index, buffer);
+  }
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+  IndexedBinding  binding{buffer, offset, size, true};
+  IndexedBinding* current = getIndexedBinding(target, index);
+  if(!current)
+  {
+    ++m_counters.issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+  else if(update(*current, binding))
+  {
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+}
+
+void GLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+  if(target == GL_FRAMEBUFFER)
+  {
+    if(m_readFramebuffer == framebuffer && m_drawFramebuffer == framebuffer)
+    {
+      ++m_counters.elided;
+      return;
+    }
+    m_readFramebuffer = framebuffer;
+    m_drawFramebuffer = framebuffer;
+    ++m_counters.issued;
+    glBindFramebuffer(target, framebuffer);
+  }
+  else if(update(target == GL_READ_FRAMEBUFFER ? m_readFramebuffer : m_drawFramebuffer, framebuffer))
+  {
+    glBindFramebuffer(target, framebuffer);
+  }
+}
+
+void GLStateCache::newBuffer(GLuint& buffer)
+{
+  deleteBuffer(buffer);
+  glCreateBuffers(1, &buffer);
+}
+
+void GLStateCache::deleteBuffer(GLuint& buffer)
+{
+  if(buffer)
+  {
+    forgetBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+  }
+}
+
+void GLStateCache::newVertexArray(GLuint& vao)
+{
+  deleteVertexArray(vao);
+  glCreateVertexArrays(1, &vao);
+}
+
+void GLStateCache::deleteVertexArray(GLuint& vao)
+{
+  if(vao)
+  {
+    if(m_vao == vao)
+    {
+      m_vao = UNKNOWN;
+    }
+    glDeleteVertexArrays(1, &vao);
+    vao = 0;
+  }
+}
+
+void GLStateCache::newFramebuffer(GLuint& framebuffer)
+{
+  deleteFramebuffer(framebuffer);
+  glCreateFramebuffers(1, &framebuffer);
+}
+
+void GLStateCache::deleteFramebuffer(GLuint& framebuffer)
+{
+  if(framebuffer)
+  {
+    if(m_readFramebuffer == framebuffer)
+    {
+      m_readFramebuffer = UNKNOWN;
+    }
+    if(m_drawFramebuffer == framebuffer)
+    {
+      m_drawFramebuffer = UNKNOWN;
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+  }
+}
+
+void GLStateCache::invalidate()
+{
+  m_program            = UNKNOWN;
+  m_vao                = UNKNOWN;
+  m_drawIndirectBuffer = UNKNOWN;
+  m_parameterBuffer    = UNKNOWN;
+  m_readFramebuffer    = UNKNOWN;
+  m_drawFramebuffer    = UNKNOWN;
+  for(uint32_t i = 0; i < MAX_INDEXED_BINDINGS; ++i)
+  {
+    m_uniformBuffers[i] = IndexedBinding();
+    m_storageBuffers[i] = IndexedBinding();
+  }
+}
+
+void GLStateCache::beginFrame()
+{
+  m_lastFrame = m_counters;
+  m_counters  = Counters();
+}
+
+void GLStateCache::forgetBuffer(GLuint buffer)
+{
+  if(m_drawIndirectBuffer == buffer)
+  {
+    m_drawIndirectBuffer = UNKNOWN;
+  }
+  if(m_parameterBuffer == buffer)
+  {
+    m_parameterBuffer = UNKNOWN;
+  }
+  for(uint32_t i = 0; i < MAX_INDEXED_BINDINGS; ++i)
+  {
+    if(m_uniformBuffers[i].buffer == buffer)
+    {
+      m_uniformBuffers[i].valid = false;
+    }
+    if(m_storageBuffers[i].buffer == buffer)
+    {
+      m_storageBuffers[i].valid = false;
+    }
+  }
+}
+
+GLStateCache::IndexedBinding* GLStateCache::getIndexedBinding(GLenum target, GLuint index)
+{
+  if(index >= MAX_INDEXED_BINDINGS)
+  {
+    return nullptr;
+  }
+  if(target == GL_UNIFORM_BUFFER)
+  {
+    return &m_uniformBuffers[index];
+  }
+  if(target == GL_SHADER_STORAGE_BUFFER)
+  {
+    return &m_storageBuffers[index];
+  }
+  return nullptr;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+
+#ifndef GL_PARAMETER_BUFFER_ARB
+#define GL_PARAMETER_BUFFER_ARB 0x80EE
+#endif
+
+/// @brief Tracks the GL bindings the sample changes per frame and skips the calls which would not change anything.
+///        Pipeline, Torus, GpuCuller and the demos bind programs, vertex arrays, buffers and framebuffers only
+///        through this class. Code changing these bindings behind its back (e.g. the ImGui renderer) has to be
+///        followed by invalidate().
+class GLStateCache
+{
+public:
+  static const uint32_t MAX_INDEXED_BINDINGS = 16;  // per indexed buffer target
+
+  /// @brief The cache shared by all of the sample's code, for the current context.
+  static GLStateCache& get();
+
+  void useProgram(GLuint program);
+  void bindVertexArray(GLuint vao);
+  /// @brief GL_DRAW_INDIRECT_BUFFER and GL_PARAMETER_BUFFER_ARB are tracked, any other target is passed through.
+  void bindBuffer(GLenum target, GLuint buffer);
+  /// @brief GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER below MAX_INDEXED_BINDINGS are tracked.
+  void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+  void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+  /// @brief GL_FRAMEBUFFER sets both, the read and the draw framebuffer.
+  void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+  /// @brief Like nvgl::newBuffer() etc., additionally forgetting the bindings of the old object
+  ///        because GL may reuse its name for the new one.
+  void newBuffer(GLuint& buffer);
+  void deleteBuffer(GLuint& buffer);
+  void newVertexArray(GLuint& vao);
+  void deleteVertexArray(GLuint& vao);
+  void newFramebuffer(GLuint& framebuffer);
+  void deleteFramebuffer(GLuint& framebuffer);
+
+  /// @brief Forgets all bindings, the next call of each kind gets issued.
+  void invalidate();
+
+  struct Counters
+  {
+    uint32_t issued = 0;  // calls made
+    uint32_t elided = 0;  // calls skipped because the binding was already set
+  };
+  /// @brief Starts counting a new frame, the counters of the finished frame stay available.
+  void            beginFrame();
+  const Counters& getFrameCounters() const { return m_lastFrame; }
+
+private:
+  GLStateCache() { invalidate(); }
+
+  // returns true if the call has to be issued and records the new value
+  template <class T>
+  bool update(T& current, const T& value)
+  {
+    if(current == value)
+    {
+      ++m_counters.elided;
+      return false;
+    }
+    current = value;
+    ++m_counters.issued;
+    return true;
+  }
+
+  struct IndexedBinding
+  {
+    GLuint     buffer = 0;
+    GLintptr   offset = 0;
+    GLsizeiptr size   = 0;  // 0 for glBindBufferBase
+    bool       valid  = false;
+
+    bool operator==(const IndexedBinding& other) const
+    {
+      return valid && other.valid && buffer == other.buffer && offset == other.offset && size == other.size;
+    }
+  };
+  IndexedBinding* getIndexedBinding(GLenum target, GLuint index);
+  void            forgetBuffer(GLuint buffer);
+
+  // ~0u: unknown
+  GLuint m_program;
+  GLuint m_vao;
+  GLuint m_drawIndirectBuffer;
+  GLuint m_parameterBuffer;
+  GLuint m_readFramebuffer;
+  GLuint m_drawFramebuffer;
+
+  IndexedBinding m_uniformBuffers[MAX_INDEXED_BINDINGS];
+  IndexedBinding m_storageBuffers[MAX_INDEXED_BINDINGS];
+
+  Counters m_counters;
+  Counters m_lastFrame;
+};
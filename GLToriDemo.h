@@ -24,14 +24,31 @@
 #include "nvgl/error_gl.hpp"
 #include "nvgl/extensions_gl.hpp"
 #include "nvh/cameracontrol.hpp"
+#include "nvh/nvprint.hpp"
+#include "nvpsystem.hpp"
 #include "imgui/backends/imgui_impl_gl.h"
 #include "imgui/imgui_helper.h"
+#include "BatchTransform.h"
+#include "CpuTrace.h"
+#include "FrustumCuller.h"
+#include "GLStateCache.h"
+#include "GpuTimers.h"
+#include "GpuCuller.h"
+#include "MemoryReport.h"
+#include "MVRSettings.h"
 #include "Pipeline.h"
 #include "Torus.h"
+#include "WorkerPool.h"
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <vector>
 
 template <class PIPELINE>
 class GLToriDemo : public nvgl::AppWindowProfilerGL
@@ -48,47 +65,157 @@ public:
   bool mouse_button(int button, int action) override { return ImGuiH::mouse_button(button, action); }
   bool mouse_wheel(int wheel) override { return ImGuiH::mouse_wheel(wheel); }
   bool key_char(int button) override { return ImGuiH::key_char(button); }
-  bool key_button(int button, int action, int mods) override { return ImGuiH::key_button(button, action, mods); }
+  bool key_button(int button, int action, int mods) override;
 
+  // renders width x height pixels (the window divided by the framebuffer scaling) and has to
+  // cover the whole window of fbo with them
   virtual void renderFrame(double time, uint32_t width, uint32_t height, GLuint fbo) = 0;
 
 protected:
   // called from think:
   virtual void       processUI(double time);
   virtual void       reloadShaders(){};
+  // bracket the whole work of one frame (e.g. for benchmarking)
+  virtual void       onFrameBegin(){};
+  virtual void       onFrameEnd(){};
+  // writes the recorded CPU zones next to the executable (F9)
+  void               writeCpuTrace();
+  // textures and buffers for the memory panel, derived demos add their own
+  virtual void       reportMemory(MemoryReport& report) const;
   nvh::CameraControl m_control;
 
   std::unique_ptr<PIPELINE> m_pipeline = nullptr;
 
+  // per pass GPU times, see GpuTimers.h
+  GpuTimers m_gpuTimers;
+
   // torus related:
-  void  renderTori(uint32_t numberOfTori, GLenum primitiveMode = GL_TRIANGLES);
+  // updateTori() stores the per object data of all tori once per frame (recomputed only if the
+  // layout or the camera changed, see m_transformCache),
+  // renderTori() draws them (possibly multiple times per frame, e.g. once per view)
+  void  updateTori(uint32_t numberOfTori, MVRSettings::DrawPath drawPath = MVRSettings::DrawPath::PER_OBJECT_DRAW);
+  void  renderTori(uint32_t              numberOfTori,
+                   GLenum                primitiveMode = GL_TRIANGLES,
+                   MVRSettings::DrawPath drawPath      = MVRSettings::DrawPath::PER_OBJECT_DRAW,
+                   uint32_t              viewMask      = ~0u);
   Torus m_torus;
   int   m_numberOfTori = 16;
   int   m_fragmentLoad = 1;
 
   float m_torus_scale = 1.0f;
 
+  // grid the tori are placed in, the instanced draw path evaluates it in the vertex shader
+  struct ToriGrid
+  {
+    uint32_t numX = 1;
+    uint32_t numY = 1;
+    float    x0   = 0.0f;
+    float    y0   = 0.0f;
+    float    dx   = 1.0f;
+    float    dy   = 1.5f;
+  } m_toriGrid;
+
+  ObjectUpdateStrategy m_objectUpdateStrategy = ObjectUpdateStrategy::PERSISTENT_RING;
+
+  // Per torus transforms and object data of the last frame. The model matrices and colors only
+  // change with the tori count or the window aspect, the object data additionally with the camera.
+  struct TransformCache
+  {
+    uint32_t numberOfTori = 0;
+    float    aspect       = 0.0f;
+
+    std::vector<glm::mat4> models;
+    std::vector<glm::vec3> colors;
+    BatchTransform         batch;   // models and colors as SoA
+    FrustumCuller          culler;  // bounding spheres as SoA
+
+    // built from models and colors for viewMatrix/projectionMatrix, empty if invalid
+    std::vector<typename PIPELINE::ObjectData> objects;
+    glm::mat4                                  viewMatrix{};
+    glm::mat4                                  projectionMatrix{};
+
+    // camera of the previous frame, while it moves the object data is written directly into the object buffer
+    glm::mat4 previousViewMatrix{};
+    glm::mat4 previousProjectionMatrix{};
+
+    // statistics, shown in the UI
+    uint64_t hits          = 0;  // frames which reused all object data
+    uint64_t cameraUpdates = 0;  // frames which rebuilt the object data for a new camera
+    uint64_t rebuilds      = 0;  // frames which rebuilt the layout
+  } m_transformCache;
+
+  BatchTransform::Kernel m_transformKernel = BatchTransform::getBestKernel();
+
+  // the per torus data of a frame is split across these threads, 0 uses all hardware threads
+  int        m_workerThreads = 0;
+  WorkerPool m_workerPool;
+
+  // all views rendered this frame, the culling and the level of detail selection consider
+  // each of them, set them before updateTori()
+  struct SceneView
+  {
+    glm::mat4 view;
+    glm::mat4 projection;
+  };
+  std::vector<SceneView> m_sceneViews;
+  float                  m_viewportHeight = 1.0f;  // in pixels
+
+  // Frustum culling: bit v of a torus' view mask is set if its bounding sphere intersects the
+  // frustum of view v, renderTori() skips the tori not visible in any of the requested views.
+  CullingMode          m_cullingMode = CullingMode::CPU;
+  std::vector<uint8_t> m_toriViewMask;        // per torus
+  std::vector<uint8_t> m_toriViewMaskPrevious;
+  uint32_t             m_visibleTori    = 0;  // in at least one view
+  uint64_t             m_cullGeneration = 0;  // incremented when m_toriViewMask changes
+
+  // Level of detail selection, see Torus::setLodCount(). Each torus uses the finest level any of
+  // the views needs, so all views render the same geometry for it.
+  float m_lodPixelsPerEdge = 8.0f;  // target length of the ring edges on screen
+
+  // result of the selection, renderTori() draws each torus with its level
+  std::vector<uint8_t>  m_toriLod;            // per torus
+  std::vector<uint32_t> m_lodDrawCounts;      // visible tori per level
+  uint64_t              m_lodTriangles  = 0;  // of all visible tori, per pass
+  uint64_t              m_lodGeneration = 0;  // incremented when m_toriLod changes
+
+  // GPU culling replaces the view masks and the level of detail selection above for multi draw indirect,
+  // call cullToriOnGPU() after updateTori() once the scene uniforms are bound
+  bool      usesGpuCulling(MVRSettings::DrawPath drawPath) const;
+  void      cullToriOnGPU(uint32_t numberOfTori, MVRSettings::DrawPath drawPath, bool perViewLists);
+  GpuCuller m_gpuCuller;
+  bool      m_gpuPerViewLists = false;
+
+  int getWindowWidth() { return m_windowState.m_winSize[0]; }
+  int getWindowHeight() { return m_windowState.m_winSize[1]; }
+
 private:
-  void clearFrameBuffer();
-  void blitFrameBufferToScreen();
+  void updateToriLayout(uint32_t numberOfTori, float aspect);
+  void transformTori(uint8_t* output, size_t stride);
+  void cullTori(uint32_t numberOfTori, bool cullingDisabled);
+  void selectToriLod(uint32_t numberOfTori, bool singleLod);
+
+  // one indirect command per torus visible in any of viewMask's views, only rebuilt if the tori count,
+  // the mesh, the visibility or the levels of detail change
+  struct IndirectCommands
+  {
+    uint32_t viewMask  = 0;
+    GLuint   buffer    = 0;
+    GLsizei  drawCount = 0;
+
+    // the state the commands were built for
+    uint32_t numberOfTori   = 0;
+    GLsizei  indexCount     = 0;
+    uint64_t cullGeneration = 0;
+    uint64_t lodGeneration  = 0;
+  };
+  const IndirectCommands&       updateIndirectCommands(uint32_t numberOfTori, uint32_t viewMask);
+  std::vector<IndirectCommands> m_indirectCommands;
 
   double m_uiTime = 0.0;
 
-  // init and resize:
-  bool initFramebuffers(int width, int height);
+  // init:
   void initCameraControl();
 
-  // OpenGL objects:
-  struct
-  {
-    GLuint scene_color        = 0;
-    GLuint scene_depthstencil = 0;
-  } m_textures;
-
-  GLuint m_fbo = 0;
-
-  int getWindowWidth() { return m_windowState.m_winSize[0]; }
-  int getWindowHeight() { return m_windowState.m_winSize[1]; }
   int getFramebufferWidth() { return (m_windowState.m_winSize[0] + m_framebufferScaling - 1) / m_framebufferScaling; }
   int getFramebufferHeight() { return (m_windowState.m_winSize[1] + m_framebufferScaling - 1) / m_framebufferScaling; }
   int m_framebufferScaling = 1;
@@ -105,42 +232,112 @@ bool GLToriDemo<PIPELINE>::begin()
   ImGui::InitGL();
 
   initCameraControl();
+  m_gpuTimers.init();
+  CpuTrace::setThreadName("Main");
 
-  bool initOK = initFramebuffers(getWindowWidth(), getWindowHeight());
-  return initOK;
+  return true;
 }
 
 template <class PIPELINE>
 void GLToriDemo<PIPELINE>::think(double time)
 {
-  ImGui::NewFrame();
-  processUI(time);
+  CPU_TRACE_ZONE("Frame");
+
+  // the bindings at the start of the frame are unknown, e.g. the window's framebuffer was swapped
+  GLStateCache::get().beginFrame();
+  GLStateCache::get().invalidate();
+
+  onFrameBegin();
+  m_gpuTimers.beginFrame();
+  m_pipeline->buildProgramsInBackground();
+
+  {
+    CPU_TRACE_ZONE("ImGui processing");
+    ImGui::NewFrame();
+    processUI(time);
+  }
 
-  m_control.processActions({m_windowState.m_winSize[0], m_windowState.m_winSize[1]},
-                           glm::vec2(m_windowState.m_mouseCurrent[0], m_windowState.m_mouseCurrent[1]),
-                           m_windowState.m_mouseButtonFlags, m_windowState.m_mouseWheel);
+  {
+    CPU_TRACE_ZONE("Camera control");
+    m_control.processActions({m_windowState.m_winSize[0], m_windowState.m_winSize[1]},
+                             glm::vec2(m_windowState.m_mouseCurrent[0], m_windowState.m_mouseCurrent[1]),
+                             m_windowState.m_mouseButtonFlags, m_windowState.m_mouseWheel);
+  }
+
+  // renderFrame() overwrites the whole window, there is nothing to clear
+  renderFrame(time, getFramebufferWidth(), getFramebufferHeight(), 0);
+  m_pipeline->endObjects();
+
+  {
+    CPU_TRACE_ZONE("ImGui render");
+    uint32_t timer = m_gpuTimers.begin("UI");
+    ImGui::Render();
+    ImGui::RenderDrawDataGL(ImGui::GetDrawData());
+    ImGui::EndFrame();
+    m_gpuTimers.end(timer);
+  }
+  // the ImGui renderer changes program, vertex array and buffer bindings behind the cache's back
+  GLStateCache::get().invalidate();
+  m_gpuTimers.endFrame();
 
-  clearFrameBuffer();
+  onFrameEnd();
+}
 
-  renderFrame(time, getFramebufferWidth(), getFramebufferHeight(), m_fbo);
+template <class PIPELINE>
+bool GLToriDemo<PIPELINE>::key_button(int button, int action, int mods)
+{
+  if(button == KEY_F9 && action == BUTTON_PRESS)
+  {
+    writeCpuTrace();
+    return true;
+  }
+  return ImGuiH::key_button(button, action, mods);
+}
 
-  blitFrameBufferToScreen();
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::writeCpuTrace()
+{
+  if(!CpuTrace::isEnabled())
+  {
+    LOGW("CPU trace: recording is disabled, enable it in the UI or with -trace 1\n");
+    return;
+  }
+  CpuTrace::writeChromeTrace(NVPSystem::exePath() + PROJECT_NAME "_trace.json");
+}
 
-  ImGui::Render();
-  ImGui::RenderDrawDataGL(ImGui::GetDrawData());
-  ImGui::EndFrame();
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::reportMemory(MemoryReport& report) const
+{
+  m_torus.reportMemory(report);
+  if(m_pipeline)
+  {
+    m_pipeline->reportMemory(report);
+  }
+  m_gpuCuller.reportMemory(report);
+  for(const IndirectCommands& commands : m_indirectCommands)
+  {
+    report.add("GLToriDemo", "indirect commands", commands.buffer ? uint64_t(commands.drawCount) * sizeof(DrawElementsIndirectCommand) : 0);
+  }
 }
 
 template <class PIPELINE>
 void GLToriDemo<PIPELINE>::end()
 {
+  m_workerPool.deinit();
+  m_gpuCuller.deinit();
+  m_gpuTimers.deinit();
+  for(IndirectCommands& commands : m_indirectCommands)
+  {
+    GLStateCache::get().deleteBuffer(commands.buffer);
+  }
+  m_indirectCommands.clear();
   ImGui::ShutdownGL();
 }
 
 template <class PIPELINE>
 void GLToriDemo<PIPELINE>::resize(int width, int height)
 {
-  initFramebuffers(width, height);
+  // renderFrame() gets the new size with the next frame
 }
 
 template <class PIPELINE>
@@ -160,29 +357,360 @@ void GLToriDemo<PIPELINE>::processUI(double time)
     ImGui::SliderInt("Framebuffer scaling", &m_framebufferScaling, 1, 16);
     ImGuiH::tooltip("The framebuffer resolution is divided by this number, then rounded up.", false, 0.f);
 
+    int objectUpdateStrategy = int(m_objectUpdateStrategy);
+    ImGui::Combo("Object data upload", &objectUpdateStrategy, "glNamedBufferSubData per draw\0Persistent mapped ring\0");
+    ImGuiH::tooltip(
+        "How the per torus uniforms get to the GPU: either updating a single UBO before each draw call, "
+        "or writing all tori once per frame into a persistently mapped ring buffer and binding them by offset.",
+        false, 0.f);
+    m_objectUpdateStrategy = ObjectUpdateStrategy(objectUpdateStrategy);
+
+    int transformKernel = int(m_transformKernel);
+    ImGui::Combo("Transform kernel", &transformKernel, "glm\0Scalar\0SSE\0AVX2\0");
+    ImGuiH::tooltip(
+        "How the per torus matrices get computed: glm per torus with a general inverse for the normal matrix, "
+        "or batched with the normal matrix derived from the model view matrix (no shearing) in scalar code, "
+        "SSE (4 tori at a time) or AVX2 (8 tori at a time). Unsupported kernels fall back to the best supported one.",
+        false, 0.f);
+    if(BatchTransform::Kernel(transformKernel) != m_transformKernel)
+    {
+      m_transformKernel = BatchTransform::Kernel(transformKernel);
+      m_transformCache.objects.clear();
+    }
+
+    const int hardwareThreads = int(WorkerPool::getHardwareThreads());
+    ImGui::SliderInt("Worker threads", &m_workerThreads, 0, hardwareThreads, m_workerThreads == 0 ? "all" : "%d");
+    ImGuiH::tooltip("Number of threads computing and storing the per torus data, 0 uses all hardware threads.", false, 0.f);
+
+    ImGui::Text("Transform cache: %llu hits, %llu camera updates, %llu rebuilds", (unsigned long long)m_transformCache.hits,
+                (unsigned long long)m_transformCache.cameraUpdates, (unsigned long long)m_transformCache.rebuilds);
+
+    const GLStateCache::Counters& glCalls = GLStateCache::get().getFrameCounters();
+    ImGui::Text("GL binds: %u issued, %u elided", glCalls.issued, glCalls.elided);
+
+    bool cpuTrace = CpuTrace::isEnabled();
+    if(ImGui::Checkbox("Record CPU trace", &cpuTrace))
+    {
+      CpuTrace::setEnabled(cpuTrace);
+    }
+    ImGuiH::tooltip("Records the CPU time of the frame sections, F9 writes them as Chrome trace JSON next to the executable.",
+                    false, 0.f);
+    ImGui::SameLine();
+    if(ImGui::Button("Write trace (F9)"))
+    {
+      writeCpuTrace();
+    }
+
+    if(ImGui::CollapsingHeader("GPU passes"))
+    {
+      for(const GpuTimers::Timer& timer : m_gpuTimers.getTimers())
+      {
+        ImGui::Text("%-16s %7.3f ms%s", timer.name.c_str(), timer.milliseconds, timer.fenced ? " (fence)" : "");
+      }
+      ImGuiH::tooltip(
+          "GPU time of each pass averaged over the last frames. Passes marked (fence) render into a multiview "
+          "framebuffer without GL_EXT_multiview_timer_query and get measured on the CPU every few frames.",
+          false, 0.f);
+    }
+
+    if(ImGui::CollapsingHeader("GPU memory"))
+    {
+      MemoryReport report;
+      reportMemory(report);
+      for(const MemoryReport::Entry& entry : report.entries)
+      {
+        ImGui::Text("%-16s %-26s %9.3f MB", entry.owner, entry.name.c_str(), double(entry.bytes) / (1024.0 * 1024.0));
+      }
+      ImGui::Text("%-43s %9.3f MB", "Total", double(report.getTotal()) / (1024.0 * 1024.0));
+      ImGuiH::tooltip("Textures and buffers owned by the demo, computed from their allocation sizes.", false, 0.f);
+    }
+
     if(ImGui::Button("Reload Shader"))
     {
       m_pipeline->reloadShaders();
+      m_gpuCuller.reloadShaders();
       reloadShaders();
+      // reloading may hand out the names of the old programs again
+      GLStateCache::get().invalidate();
     }
   }
   ImGui::End();
 }
 
 template <class PIPELINE>
-void GLToriDemo<PIPELINE>::renderTori(uint32_t numberOfTori, GLenum primitiveMode)
+void GLToriDemo<PIPELINE>::updateTori(uint32_t numberOfTori, MVRSettings::DrawPath drawPath)
 {
-  m_torus.setBufferState();
+  CPU_TRACE_ZONE("updateTori");
+
+  // instanced tori don't need any per object data
+  const bool storeObjects = drawPath != MVRSettings::DrawPath::INSTANCED_GRID;
+
+  m_pipeline->setObjectUpdateStrategy(m_objectUpdateStrategy);
+  m_pipeline->beginObjects(storeObjects ? numberOfTori : 0);
+
+  const uint32_t numThreads = m_workerThreads > 0 ? uint32_t(m_workerThreads) : WorkerPool::getHardwareThreads();
+  if(m_workerPool.getNumThreads() != numThreads)
+  {
+    m_workerPool.init(numThreads);
+  }
 
-  const float num    = (float)numberOfTori;
-  const int   width  = m_windowState.m_winSize[0];
-  const int   height = m_windowState.m_winSize[1];
+  TransformCache& cache  = m_transformCache;
+  const float     aspect = (float)m_windowState.m_winSize[0] / (float)m_windowState.m_winSize[1];
+
+  if(cache.numberOfTori != numberOfTori || cache.aspect != aspect)
+  {
+    updateToriLayout(numberOfTori, aspect);
+    cache.objects.clear();
+    ++cache.rebuilds;
+  }
+
+  // the instanced grid draws all tori with the same level and can't skip any of them,
+  // with GPU culling both happen in cullToriOnGPU()
+  const bool gpuCulling = usesGpuCulling(drawPath);
+  cullTori(numberOfTori, !storeObjects || gpuCulling);
+  selectToriLod(numberOfTori, !storeObjects || gpuCulling);
+
+  if(!storeObjects)
+  {
+    return;
+  }
+
+  // only the object data depends on the camera
+  const glm::mat4& view       = m_pipeline->getViewMatrix();
+  const glm::mat4& projection = m_pipeline->getProjectionMatrix();
+  const bool       cameraMoving = view != cache.previousViewMatrix || projection != cache.previousProjectionMatrix;
+  cache.previousViewMatrix       = view;
+  cache.previousProjectionMatrix = projection;
+
+  if(cache.objects.size() == numberOfTori && cache.viewMatrix == view && cache.projectionMatrix == projection)
+  {
+    ++cache.hits;
+  }
+  else if(cameraMoving)
+  {
+    // the result won't be reused, write it straight into this frame's object data
+    transformTori(m_pipeline->getObjectStorage(), m_pipeline->getObjectStride());
+    cache.objects.clear();
+    ++cache.cameraUpdates;
+    return;
+  }
+  else
+  {
+    cache.viewMatrix       = view;
+    cache.projectionMatrix = projection;
+    cache.objects.resize(numberOfTori);
+    transformTori((uint8_t*)cache.objects.data(), sizeof(typename PIPELINE::ObjectData));
+    ++cache.cameraUpdates;
+  }
+
+  // the data still has to be stored every frame, each frame writes its own part of the ring
+  m_workerPool.parallelFor(numberOfTori, 1024, 1, [&](uint32_t first, uint32_t count) {
+    for(uint32_t i = first; i < first + count; ++i)
+    {
+      m_pipeline->storeObject(i, cache.objects[i]);
+    }
+  });
+}
+
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::transformTori(uint8_t* output, size_t stride)
+{
+  using ObjectData = typename PIPELINE::ObjectData;
+
+  BatchTransform::OutputLayout layout;
+  layout.stride        = stride;
+  layout.model         = offsetof(ObjectData, model);
+  layout.modelView     = offsetof(ObjectData, modelView);
+  layout.modelViewIT   = offsetof(ObjectData, modelViewIT);
+  layout.modelViewProj = offsetof(ObjectData, modelViewProj);
+  layout.color         = offsetof(ObjectData, color);
+  layout.index         = offsetof(ObjectData, index);
+
+  const glm::mat4& view       = m_pipeline->getViewMatrix();
+  const glm::mat4& projection = m_pipeline->getProjectionMatrix();
+
+  // batches are multiples of 8 tori to keep the SIMD kernels busy
+  m_workerPool.parallelFor(m_transformCache.batch.getCount(), 256, 8, [&](uint32_t first, uint32_t count) {
+    m_transformCache.batch.transform(m_transformKernel, view, projection, layout, output, first, count);
+  });
+}
+
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::cullTori(uint32_t numberOfTori, bool cullingDisabled)
+{
+  // without any views (or culling) every torus counts as visible in all of them
+  const uint32_t numViews = uint32_t(m_sceneViews.size());
+  const uint8_t  allViews = numViews == 0 || numViews >= FrustumCuller::MAX_CULL_VIEWS ? 0xff : uint8_t((1u << numViews) - 1);
+
+  std::vector<uint8_t>& masks = m_toriViewMask;
+  if(masks.size() != numberOfTori)
+  {
+    masks.assign(numberOfTori, allViews);
+    ++m_cullGeneration;
+  }
+
+  if(m_cullingMode != CullingMode::DISABLED && !cullingDisabled)
+  {
+    std::vector<glm::mat4> viewProjections;
+    for(const SceneView& sceneView : m_sceneViews)
+    {
+      viewProjections.push_back(sceneView.projection * sceneView.view);
+    }
+    FrustumCuller& culler = m_transformCache.culler;
+    culler.setViews(viewProjections.data(), uint32_t(viewProjections.size()));
+
+    // all views of a batch of tori in one pass, cull into a copy to find out if anything changed
+    std::vector<uint8_t>& previousMasks = m_toriViewMaskPrevious;
+    previousMasks.swap(masks);
+    masks.resize(numberOfTori);
+    std::atomic<bool> changed{false};
+    m_workerPool.parallelFor(numberOfTori, 1024, 8, [&](uint32_t first, uint32_t count) {
+      culler.cull(m_transformKernel, masks.data(), first, count);
+      if(memcmp(masks.data() + first, previousMasks.data() + first, count) != 0)
+      {
+        changed = true;
+      }
+    });
+
+    if(changed)
+    {
+      ++m_cullGeneration;
+    }
+  }
+  else if(std::any_of(masks.begin(), masks.end(), [&](uint8_t mask) { return mask != allViews; }))
+  {
+    std::fill(masks.begin(), masks.end(), allViews);
+    ++m_cullGeneration;
+  }
+
+  m_visibleTori = uint32_t(std::count_if(masks.begin(), masks.end(), [](uint8_t mask) { return mask != 0; }));
+}
+
+template <class PIPELINE>
+bool GLToriDemo<PIPELINE>::usesGpuCulling(MVRSettings::DrawPath drawPath) const
+{
+  // the other draw paths need the visible tori on the CPU
+  return m_cullingMode == CullingMode::GPU && drawPath == MVRSettings::DrawPath::MULTI_DRAW_INDIRECT && m_gpuCuller.isValid();
+}
+
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::cullToriOnGPU(uint32_t numberOfTori, MVRSettings::DrawPath drawPath, bool perViewLists)
+{
+  if(!usesGpuCulling(drawPath))
+  {
+    return;
+  }
+
+  GpuCuller::Parameters parameters;
+  parameters.numObjects     = numberOfTori;
+  parameters.numViews       = uint32_t(m_sceneViews.size());
+  parameters.perViewLists   = perViewLists;
+  parameters.viewportHeight = m_viewportHeight;
+  parameters.pixelsPerEdge  = m_lodPixelsPerEdge;
+  m_gpuPerViewLists         = perViewLists;
+
+  m_pipeline->bindObjectArray();
+  m_gpuCuller.cull(m_torus, parameters);
+}
+
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::selectToriLod(uint32_t numberOfTori, bool singleLod)
+{
+  const uint32_t lodCount = m_torus.getLodCount();
+
+  std::vector<uint8_t>& toriLod = m_toriLod;
+  if(toriLod.size() != numberOfTori)
+  {
+    toriLod.assign(numberOfTori, 0);
+    ++m_lodGeneration;
+  }
+
+  if(lodCount > 1 && !singleLod && !m_sceneViews.empty())
+  {
+    // bounding sphere of the torus in model space, the models only scale uniformly
+    const float radius = m_torus_scale * (m_torus.getInnerRadius() + m_torus.getOuterRadius());
+
+    // coarsest level whose ring edges are at most m_lodPixelsPerEdge long on screen,
+    // with the ring's circumference being pi times the projected diameter
+    std::vector<float> minDiameter(lodCount);
+    for(uint32_t lod = 0; lod < lodCount; ++lod)
+    {
+      minDiameter[lod] = m_lodPixelsPerEdge * float(m_torus.getLodTessellationM(lod)) / glm::pi<float>();
+    }
+
+    std::atomic<bool> changed{false};
+    m_workerPool.parallelFor(numberOfTori, 1024, 1, [&](uint32_t first, uint32_t count) {
+      bool batchChanged = false;
+      for(uint32_t i = first; i < first + count; ++i)
+      {
+        const glm::vec4 center = m_transformCache.models[i][3];
+
+        // largest projected diameter in pixels across all views
+        float diameter = 0.0f;
+        for(const SceneView& sceneView : m_sceneViews)
+        {
+          const float depth = -(sceneView.view * center).z;
+          if(depth <= radius)
+          {
+            // the camera is inside or close to the bounding sphere
+            diameter = std::numeric_limits<float>::max();
+            break;
+          }
+          diameter = std::max(diameter, radius * sceneView.projection[1][1] / depth * m_viewportHeight);
+        }
+
+        uint8_t lod = 0;
+        while(lod + 1u < lodCount && diameter <= minDiameter[lod + 1])
+        {
+          ++lod;
+        }
+
+        if(toriLod[i] != lod)
+        {
+          toriLod[i]   = lod;
+          batchChanged = true;
+        }
+      }
+      if(batchChanged)
+      {
+        changed = true;
+      }
+    });
+
+    if(changed)
+    {
+      ++m_lodGeneration;
+    }
+  }
+  else if(std::any_of(toriLod.begin(), toriLod.end(), [](uint8_t lod) { return lod != 0; }))
+  {
+    std::fill(toriLod.begin(), toriLod.end(), uint8_t(0));
+    ++m_lodGeneration;
+  }
+
+  m_lodDrawCounts.assign(lodCount, 0);
+  for(uint32_t i = 0; i < numberOfTori; ++i)
+  {
+    if(m_toriViewMask[i])
+    {
+      ++m_lodDrawCounts[toriLod[i]];
+    }
+  }
+  m_lodTriangles = 0;
+  for(uint32_t lod = 0; lod < lodCount; ++lod)
+  {
+    m_lodTriangles += uint64_t(m_lodDrawCounts[lod]) * m_torus.getTriangleCount(lod);
+  }
+}
+
+template <class PIPELINE>
+void GLToriDemo<PIPELINE>::updateToriLayout(uint32_t numberOfTori, float aspect)
+{
+  const float num = (float)numberOfTori;
 
   // distribute num tori into an numX x numY pattern
   // with numX * numY > num, numX = aspect * numY
 
-  const float aspect = (float)width / (float)height;
-
   size_t numX = static_cast<size_t>(ceil(sqrt(num * aspect)));
   size_t numY = static_cast<size_t>((float)numX / aspect);
   if(numX * numY < num)
@@ -200,8 +728,15 @@ void GLToriDemo<PIPELINE>::renderTori(uint32_t numberOfTori, GLenum primitiveMod
   const float y0 = -sy / 2.0f + ry;
 
   m_torus_scale = std::min(1.f / sx, 1.f / sy) * 0.8f;
+  m_toriGrid    = {uint32_t(numX), uint32_t(numY), x0, y0, dx, dy};
 
-  size_t torusIndex = 0;
+  TransformCache& cache = m_transformCache;
+  cache.numberOfTori    = numberOfTori;
+  cache.aspect          = aspect;
+  cache.models.resize(numberOfTori);
+  cache.colors.resize(numberOfTori);
+
+  uint32_t torusIndex = 0;
   for(size_t i = 0; i < numY && torusIndex < numberOfTori; ++i)
   {
     for(size_t j = 0; j < numX && torusIndex < numberOfTori; ++j)
@@ -209,12 +744,10 @@ void GLToriDemo<PIPELINE>::renderTori(uint32_t numberOfTori, GLenum primitiveMod
       float y = y0 + i * dy;
       float x = x0 + j * dx;
 
-      float     rotationAngle = (j % 2 ? -1.0f : 1.0f) * 45.0f * glm::pi<float>() / 180.0f;
-      glm::mat4 modelMatrix   = glm::scale(glm::mat4(1.0f), glm::vec3(m_torus_scale))
-                              * glm::translate(glm::mat4(1.f), glm::vec3(x, y, 0.0f))
-                              * glm::rotate(glm::mat4(1.f), rotationAngle, glm::vec3(1, 0, 0));
-
-      m_pipeline->setModelMatrix(modelMatrix);
+      float rotationAngle      = (j % 2 ? -1.0f : 1.0f) * 45.0f * glm::pi<float>() / 180.0f;
+      cache.models[torusIndex] = glm::scale(glm::mat4(1.0f), glm::vec3(m_torus_scale))
+                                 * glm::translate(glm::mat4(1.f), glm::vec3(x, y, 0.0f))
+                                 * glm::rotate(glm::mat4(1.f), rotationAngle, glm::vec3(1, 0, 0));
 
       // Use colors light blue and green
       int       colorIndex = torusIndex % 5;
@@ -223,60 +756,119 @@ void GLToriDemo<PIPELINE>::renderTori(uint32_t numberOfTori, GLenum primitiveMod
       {
         color = glm::vec3(0, 1, 0);
       }
-
-      m_pipeline->setObjectColor(color);
-      m_pipeline->updateObjectUniforms();
-
-      m_torus.draw(primitiveMode);
+      cache.colors[torusIndex] = color;
 
       ++torusIndex;
     }
   }
 
-  m_torus.unsetBufferState();
-}
+  cache.batch.setObjects(cache.models.data(), cache.colors.data(), numberOfTori);
 
-template <class PIPELINE>
-void GLToriDemo<PIPELINE>::clearFrameBuffer()
-{
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-  glViewport(0, 0, getWindowWidth(), getWindowHeight());
-  glClearColor(1.0, 1.0, 1.0, 1.0);
-  glClearDepth(1.0);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-  glEnable(GL_DEPTH_TEST);
+  // the models scale uniformly, the torus fits into a sphere of radius inner + outer radius
+  const float            radius = m_torus_scale * (m_torus.getInnerRadius() + m_torus.getOuterRadius());
+  std::vector<glm::vec4> spheres(numberOfTori);
+  for(uint32_t i = 0; i < numberOfTori; ++i)
+  {
+    spheres[i] = glm::vec4(glm::vec3(cache.models[i][3]), radius);
+  }
+  cache.culler.setSpheres(spheres.data(), numberOfTori);
 }
 
 template <class PIPELINE>
-void GLToriDemo<PIPELINE>::blitFrameBufferToScreen()
+void GLToriDemo<PIPELINE>::renderTori(uint32_t numberOfTori, GLenum primitiveMode, MVRSettings::DrawPath drawPath, uint32_t viewMask)
 {
-  // blit to background
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-  glBlitFramebuffer(0, 0, getFramebufferWidth(), getFramebufferHeight(), 0, 0, getWindowWidth(), getWindowHeight(),
-                    GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  CPU_TRACE_ZONE("renderTori");
+
+  m_torus.setBufferState();
+
+  if(usesGpuCulling(drawPath))
+  {
+    // the commands were written by cullToriOnGPU(), a single view gets its own list if there is one
+    uint32_t list = GpuCuller::ANY_VIEW_LIST;
+    for(uint32_t view = 0; view < MAX_VIEWS && m_gpuPerViewLists; ++view)
+    {
+      if(viewMask == 1u << view)
+      {
+        list = view;
+      }
+    }
+    m_pipeline->bindObjectArray();
+    m_gpuCuller.draw(m_torus, primitiveMode, list);
+  }
+  else if(drawPath == MVRSettings::DrawPath::MULTI_DRAW_INDIRECT)
+  {
+    // all visible tori in one submission, the shaders fetch the object data by the base instance
+    const IndirectCommands& commands = updateIndirectCommands(numberOfTori, viewMask);
+    if(commands.drawCount > 0)
+    {
+      m_pipeline->bindObjectArray();
+
+      GLStateCache::get().bindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.buffer);
+      m_torus.drawMultiIndirect(primitiveMode, commands.drawCount);
+    }
+  }
+  else if(drawPath == MVRSettings::DrawPath::INSTANCED_GRID)
+  {
+    m_torus.drawInstanced(primitiveMode, numberOfTori);
+  }
+  else
+  {
+    for(uint32_t torusIndex = 0; torusIndex < numberOfTori; ++torusIndex)
+    {
+      if(!(m_toriViewMask[torusIndex] & viewMask))
+      {
+        continue;
+      }
+      m_pipeline->bindObject(torusIndex);
+      m_torus.draw(primitiveMode, m_toriLod[torusIndex]);
+    }
+  }
+
+  m_torus.unsetBufferState();
 }
 
 template <class PIPELINE>
-bool GLToriDemo<PIPELINE>::initFramebuffers(int width, int height)
+const typename GLToriDemo<PIPELINE>::IndirectCommands& GLToriDemo<PIPELINE>::updateIndirectCommands(uint32_t numberOfTori,
+                                                                                                    uint32_t viewMask)
 {
-  const GLsizei mipLevels = 1;
-
-  nvgl::newTexture(m_textures.scene_color, GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, m_textures.scene_color);
-  glTexStorage2D(GL_TEXTURE_2D, mipLevels, GL_RGBA8, width, height);
+  // one set of commands per view mask, e.g. one per view in the software fallback
+  auto it = std::find_if(m_indirectCommands.begin(), m_indirectCommands.end(),
+                         [&](const IndirectCommands& commands) { return commands.viewMask == viewMask; });
+  if(it == m_indirectCommands.end())
+  {
+    m_indirectCommands.emplace_back();
+    it           = m_indirectCommands.end() - 1;
+    it->viewMask = viewMask;
+  }
+  IndirectCommands& indirect = *it;
 
-  nvgl::newTexture(m_textures.scene_depthstencil, GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, m_textures.scene_depthstencil);
-  glTexStorage2D(GL_TEXTURE_2D, mipLevels, GL_DEPTH24_STENCIL8, width, height);
+  if(indirect.buffer && numberOfTori == indirect.numberOfTori && m_torus.getIndexCount() == indirect.indexCount
+     && m_cullGeneration == indirect.cullGeneration && m_lodGeneration == indirect.lodGeneration)
+  {
+    return indirect;
+  }
 
-  nvgl::newFramebuffer(m_fbo);
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_textures.scene_color, 0);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_textures.scene_depthstencil, 0);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  std::vector<DrawElementsIndirectCommand> commands;
+  commands.reserve(numberOfTori);
+  for(uint32_t torusIndex = 0; torusIndex < numberOfTori; ++torusIndex)
+  {
+    if(!(m_toriViewMask[torusIndex] & viewMask))
+    {
+      continue;
+    }
+    DrawElementsIndirectCommand command = m_torus.getDrawCommand(m_toriLod[torusIndex]);
+    command.baseInstance                = torusIndex;
+    commands.push_back(command);
+  }
 
-  return true;
+  GLStateCache::get().newBuffer(indirect.buffer);
+  glNamedBufferData(indirect.buffer, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+  indirect.drawCount      = GLsizei(commands.size());
+  indirect.numberOfTori   = numberOfTori;
+  indirect.indexCount     = m_torus.getIndexCount();
+  indirect.cullGeneration = m_cullGeneration;
+  indirect.lodGeneration  = m_lodGeneration;
+  return indirect;
 }
 
 template <class PIPELINE>
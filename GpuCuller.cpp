@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "GpuCuller.h"
+#include "GLStateCache.h"
+
+#include "nvgl/contextwindow_gl.hpp"
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Search paths for shaders, defined in main.cpp
+extern std::vector<std::string> defaultSearchPaths;
+
+bool GpuCuller::init(bool supportIndirectParameters)
+{
+  for(const auto& path : defaultSearchPaths)
+  {
+    m_progManager.addDirectory(path);
+  }
+  m_progManager.registerInclude("common.h", "common.h");
+  m_progManager.registerInclude("mvr_torus.glsl", "mvr_torus.glsl");
+  m_program = m_progManager.createProgram(
+      nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define USE_OBJECT_SSBO\n", "mvr_cull.comp.glsl"));
+  if(!m_progManager.areProgramsValid())
+  {
+    LOGE("Error loading the culling shader\n");
+    return false;
+  }
+
+  if(supportIndirectParameters)
+  {
+    m_multiDrawElementsIndirectCount = (PFN_MultiDrawElementsIndirectCount)nvgl::ContextWindow::sysGetProcAddress(
+        "glMultiDrawElementsIndirectCountARB");
+  }
+
+  GLStateCache::get().newBuffer(m_cullUbo);
+  glNamedBufferData(m_cullUbo, sizeof(vertexload::CullData), nullptr, GL_DYNAMIC_DRAW);
+  GLStateCache::get().newBuffer(m_countBuffer);
+  glNamedBufferData(m_countBuffer, NUM_LISTS * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+  return true;
+}
+
+void GpuCuller::deinit()
+{
+  m_progManager.deletePrograms();
+  GLStateCache::get().deleteBuffer(m_cullUbo);
+  GLStateCache::get().deleteBuffer(m_commandBuffer);
+  GLStateCache::get().deleteBuffer(m_countBuffer);
+  m_capacity                       = 0;
+  m_multiDrawElementsIndirectCount = nullptr;
+}
+
+void GpuCuller::cull(const Torus& torus, const Parameters& parameters)
+{
+  m_numObjects = parameters.numObjects;
+  if(m_numObjects > m_capacity)
+  {
+    m_capacity = std::max(m_numObjects, m_capacity * 2);
+    GLStateCache::get().newBuffer(m_commandBuffer);
+    glNamedBufferData(m_commandBuffer, GLsizeiptr(NUM_LISTS) * m_capacity * sizeof(DrawElementsIndirectCommand),
+                      nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  vertexload::CullData cullData{};
+  cullData.boundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, torus.getInnerRadius() + torus.getOuterRadius());
+  cullData.counts         = glm::ivec4(m_numObjects, std::min(parameters.numViews, uint32_t(MAX_VIEWS)),
+                                       std::min(torus.getLodCount(), uint32_t(MAX_LODS)), m_capacity);
+  cullData.flags          = glm::ivec4(parameters.perViewLists ? 1 : 0, usesDrawCount() ? 1 : 0, 0, 0);
+  cullData.lodSelection   = glm::vec4(parameters.viewportHeight, parameters.pixelsPerEdge, 0.0f, 0.0f);
+  for(uint32_t lod = 0; lod < uint32_t(cullData.counts.z); ++lod)
+  {
+    const DrawElementsIndirectCommand command = torus.getDrawCommand(lod);
+    cullData.lods[lod] = glm::ivec4(command.firstIndex, command.count, command.baseVertex, torus.getLodTessellationM(lod));
+  }
+  glNamedBufferSubData(m_cullUbo, 0, sizeof(cullData), &cullData);
+
+  const GLuint zero = 0;
+  glClearNamedBufferData(m_countBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+  GLStateCache& state = GLStateCache::get();
+  state.bindBufferBase(GL_UNIFORM_BUFFER, UBO_CULL, m_cullUbo);
+  state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_COMMANDS, m_commandBuffer);
+  state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_COUNTS, m_countBuffer);
+
+  state.useProgram(m_progManager.get(m_program));
+  glDispatchCompute((m_numObjects + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+  // the commands and counts get consumed by the following draw calls
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void GpuCuller::draw(Torus& torus, GLenum primitiveMode, uint32_t list)
+{
+  if(m_numObjects == 0)
+  {
+    return;
+  }
+
+  const GLintptr commandOffset = GLintptr(list) * m_capacity * sizeof(DrawElementsIndirectCommand);
+  GLStateCache& state = GLStateCache::get();
+  state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+  if(usesDrawCount())
+  {
+    state.bindBuffer(GL_PARAMETER_BUFFER_ARB, m_countBuffer);
+    m_multiDrawElementsIndirectCount(primitiveMode, torus.getIndexType(), (const void*)commandOffset,
+                                     GLintptr(list * sizeof(GLuint)), m_numObjects, 0);
+  }
+  else
+  {
+    // the commands of the invisible tori have an instance count of 0
+    torus.drawMultiIndirect(primitiveMode, m_numObjects, commandOffset);
+  }
+}
+
+void GpuCuller::reportMemory(MemoryReport& report) const
+{
+  report.add("GpuCuller", "cull UBO", m_cullUbo ? sizeof(vertexload::CullData) : 0);
+  report.add("GpuCuller", "draw counts", m_countBuffer ? NUM_LISTS * sizeof(GLuint) : 0);
+  report.add("GpuCuller", "command lists", uint64_t(NUM_LISTS) * m_capacity * sizeof(DrawElementsIndirectCommand));
+}
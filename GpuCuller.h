@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+#include "nvgl/programmanager_gl.hpp"
+
+#include <glm/glm.hpp>
+#include "common.h"
+#include "MemoryReport.h"
+#include "Torus.h"
+
+#include <cstdint>
+
+/// @brief Culls and selects the level of detail of all tori on the GPU (see mvr_cull.comp.glsl).
+///        A compute pass reads the model matrices from the object array (SSBO_OBJECT), tests the bounding
+///        spheres against the frusta of all views of the scene UBO and writes the indirect draw commands of
+///        the visible tori. With GL_ARB_indirect_parameters the commands get compacted and the draw count is
+///        read from a buffer, otherwise each list holds one command per torus with an instance count of 0 or 1.
+class GpuCuller
+{
+public:
+  // one command list per view (e.g. the passes of the software fallback) and one for the tori visible in any view
+  static const uint32_t NUM_LISTS     = MAX_VIEWS + 1;
+  static const uint32_t ANY_VIEW_LIST = MAX_VIEWS;
+
+  /// @brief Compiles the compute shader, requires a current context.
+  bool init(bool supportIndirectParameters);
+  void deinit();
+  void reloadShaders() { m_progManager.reloadPrograms(); }
+
+  bool isValid() const { return m_progManager.isValid(m_program); }
+  bool usesDrawCount() const { return m_multiDrawElementsIndirectCount != nullptr; }
+
+  struct Parameters
+  {
+    uint32_t numObjects     = 0;
+    uint32_t numViews       = 2;
+    bool     perViewLists   = false;  // one list per view instead of one for the tori visible in any view
+    float    viewportHeight = 1.0f;   // in pixels
+    float    pixelsPerEdge  = 8.0f;   // target length of the ring edges on screen, see GLToriDemo::selectToriLod()
+  };
+
+  /// @brief Writes the command lists, call after the object array and the scene UBO are bound.
+  ///        Changes the current program.
+  void cull(const Torus& torus, const Parameters& parameters);
+
+  /// @brief Draws one of the lists written by the last cull(), the torus buffer state has to be set.
+  void draw(Torus& torus, GLenum primitiveMode, uint32_t list);
+
+  void reportMemory(MemoryReport& report) const;
+
+private:
+  nvgl::ProgramManager m_progManager;
+  nvgl::ProgramID      m_program;
+
+  GLuint   m_cullUbo       = 0;
+  GLuint   m_commandBuffer = 0;  // NUM_LISTS lists of m_capacity commands
+  GLuint   m_countBuffer   = 0;  // NUM_LISTS draw counts
+  uint32_t m_capacity      = 0;
+  uint32_t m_numObjects    = 0;  // of the last cull()
+
+  typedef void(APIENTRYP PFN_MultiDrawElementsIndirectCount)(GLenum      mode,
+                                                              GLenum      type,
+                                                              const void* indirect,
+                                                              GLintptr    drawcount,
+                                                              GLsizei     maxdrawcount,
+                                                              GLsizei     stride);
+  PFN_MultiDrawElementsIndirectCount m_multiDrawElementsIndirectCount = nullptr;
+};
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "GpuTimers.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const uint32_t INVALID_HANDLE = ~0u;
+
+// the CPU waits for the GPU with this timeout when measuring with fences
+const GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
+void waitForGpu()
+{
+  GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+  glDeleteSync(sync);
+}
+}  // namespace
+
+void GpuTimers::init()
+{
+  for(Frame& frame : m_frames)
+  {
+    glCreateQueries(GL_TIMESTAMP, MAX_QUERIES * 2, frame.queries);
+    frame.pending = false;
+  }
+}
+
+void GpuTimers::deinit()
+{
+  for(Frame& frame : m_frames)
+  {
+    if(frame.queries[0])
+    {
+      glDeleteQueries(MAX_QUERIES * 2, frame.queries);
+      memset(frame.queries, 0, sizeof(frame.queries));
+    }
+    frame.pending = false;
+  }
+  m_sums.clear();
+  m_timers.clear();
+  m_summedFrames = 0;
+}
+
+void GpuTimers::beginFrame()
+{
+  Frame& frame = m_frames[m_frameIndex % RING_FRAMES];
+  if(frame.pending)
+  {
+    readBack(frame);
+  }
+  frame.numQueries = 0;
+  frame.passes.clear();
+  m_frameActive = frame.queries[0] != 0;
+}
+
+void GpuTimers::endFrame()
+{
+  if(!m_frameActive)
+  {
+    return;
+  }
+  m_frames[m_frameIndex % RING_FRAMES].pending = true;
+  m_frameActive                                = false;
+  ++m_frameIndex;
+}
+
+uint32_t GpuTimers::begin(const char* name, bool multiview)
+{
+  Frame& frame = m_frames[m_frameIndex % RING_FRAMES];
+  if(!m_frameActive || frame.numQueries + 2 > MAX_QUERIES * 2)
+  {
+    return INVALID_HANDLE;
+  }
+
+  Query query;
+  query.name               = name;
+  query.queryIndex         = frame.numQueries;
+  query.fenced             = multiview && !m_multiviewTimestamps;
+  query.fencedMilliseconds = 0.0;
+  if(query.fenced)
+  {
+    if(m_frameIndex % FENCE_INTERVAL != 0)
+    {
+      return INVALID_HANDLE;
+    }
+    waitForGpu();
+    m_fenceStart = std::chrono::high_resolution_clock::now();
+  }
+  else
+  {
+    glQueryCounter(frame.queries[query.queryIndex], GL_TIMESTAMP);
+    frame.numQueries += 2;
+  }
+
+  frame.passes.push_back(query);
+  return uint32_t(frame.passes.size() - 1);
+}
+
+void GpuTimers::end(uint32_t handle)
+{
+  Frame& frame = m_frames[m_frameIndex % RING_FRAMES];
+  if(!m_frameActive || handle >= frame.passes.size())
+  {
+    return;
+  }
+
+  Query& query = frame.passes[handle];
+  if(query.fenced)
+  {
+    waitForGpu();
+    query.fencedMilliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_fenceStart).count();
+  }
+  else
+  {
+    glQueryCounter(frame.queries[query.queryIndex + 1], GL_TIMESTAMP);
+  }
+}
+
+void GpuTimers::readBack(Frame& frame)
+{
+  frame.pending = false;
+
+  // the timestamps finish in order, the last one tells if all of them are available
+  if(frame.numQueries > 0)
+  {
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[frame.numQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available)
+    {
+      // never wait, drop the frame
+      return;
+    }
+  }
+
+  // passes timed more than once per frame are summed up first
+  struct FrameSum
+  {
+    const char* name;
+    double      milliseconds;
+    bool        fenced;
+  };
+  std::vector<FrameSum> frameSums;
+
+  GLuint64 first = ~GLuint64(0);
+  GLuint64 last  = 0;
+  for(const Query& query : frame.passes)
+  {
+    double milliseconds = query.fencedMilliseconds;
+    if(!query.fenced)
+    {
+      GLuint64 begin = 0, end = 0;
+      glGetQueryObjectui64v(frame.queries[query.queryIndex], GL_QUERY_RESULT, &begin);
+      glGetQueryObjectui64v(frame.queries[query.queryIndex + 1], GL_QUERY_RESULT, &end);
+      milliseconds = double(end - begin) / 1000000.0;
+      first        = std::min(first, begin);
+      last         = std::max(last, end);
+    }
+
+    FrameSum* sum = nullptr;
+    for(FrameSum& frameSum : frameSums)
+    {
+      if(strcmp(frameSum.name, query.name) == 0)
+      {
+        sum = &frameSum;
+      }
+    }
+    if(sum)
+    {
+      sum->milliseconds += milliseconds;
+    }
+    else
+    {
+      frameSums.push_back({query.name, milliseconds, query.fenced});
+    }
+  }
+
+  for(const FrameSum& frameSum : frameSums)
+  {
+    addSample(frameSum.name, frameSum.milliseconds, frameSum.fenced);
+  }
+  // the GPU idles while the CPU waits for a fence, leave such frames out of the whole frame time
+  const bool fenced = std::any_of(frame.passes.begin(), frame.passes.end(), [](const Query& query) { return query.fenced; });
+  if(last > first && !fenced)
+  {
+    addSample("Frame", double(last - first) / 1000000.0, false);
+  }
+
+  ++m_summedFrames;
+  if(m_summedFrames >= AVERAGE_FRAMES)
+  {
+    // the whole frame goes last
+    m_timers.clear();
+    Timer frameTimer;
+    for(const Sum& sum : m_sums)
+    {
+      Timer timer;
+      timer.name         = sum.name;
+      timer.milliseconds = sum.milliseconds / double(sum.samples);
+      timer.fenced       = sum.fenced;
+      if(sum.name == "Frame")
+      {
+        frameTimer = timer;
+      }
+      else
+      {
+        m_timers.push_back(timer);
+      }
+    }
+    if(!frameTimer.name.empty())
+    {
+      m_timers.push_back(frameTimer);
+    }
+    m_sums.clear();
+    m_summedFrames = 0;
+  }
+}
+
+void GpuTimers::addSample(const char* name, double milliseconds, bool fenced)
+{
+  for(Sum& sum : m_sums)
+  {
+    if(sum.name == name)
+    {
+      sum.milliseconds += milliseconds;
+      sum.samples++;
+      return;
+    }
+  }
+  Sum sum;
+  sum.name         = name;
+  sum.milliseconds = milliseconds;
+  sum.samples      = 1;
+  sum.fenced       = fenced;
+  m_sums.push_back(sum);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief GPU times of the passes of a frame, measured with timestamp queries which are read back a few frames later
+///        without ever waiting for them (a frame whose queries aren't available when its slot in the ring is needed
+///        again is dropped). Passes can be timed several times per frame, their times are summed up by name.
+///        Timestamps are undefined while a multiview framebuffer is bound unless GL_EXT_multiview_timer_query is
+///        supported, such passes fall back to CPU side fence timing: every FENCE_INTERVAL frames the pass is
+///        bracketed by fences the CPU waits for, which stalls that frame but keeps the numbers coming.
+class GpuTimers
+{
+public:
+  static const uint32_t RING_FRAMES    = 4;   // frames in flight before a query slot gets reused
+  static const uint32_t MAX_QUERIES    = 32;  // begin()/end() pairs per frame
+  static const uint32_t FENCE_INTERVAL = 16;  // frames between two fence measurements
+  static const uint32_t AVERAGE_FRAMES = 32;  // the reported times are averaged over this many frames
+
+  void init();
+  void deinit();
+
+  /// @brief Set to true if GL_EXT_multiview_timer_query is supported.
+  void setMultiviewTimestamps(bool supported) { m_multiviewTimestamps = supported; }
+
+  /// @brief Reads back the results which are available and starts the queries of a new frame.
+  void beginFrame();
+  void endFrame();
+
+  /// @brief Starts timing the pass 'name' (must stay valid until endFrame()), 'multiview' if a multiview framebuffer
+  ///        is bound during the pass. Returns the handle for end().
+  uint32_t begin(const char* name, bool multiview = false);
+  void     end(uint32_t handle);
+
+  struct Timer
+  {
+    std::string name;
+    double      milliseconds = 0.0;
+    bool        fenced       = false;  // measured with fences on the CPU
+  };
+  /// @brief The averaged times of the passes in the order they were first seen, the last one is the whole frame.
+  const std::vector<Timer>& getTimers() const { return m_timers; }
+
+private:
+  struct Query
+  {
+    const char* name;
+    uint32_t    queryIndex;  // of the begin timestamp, end is queryIndex + 1
+    bool        fenced;
+    double      fencedMilliseconds;
+  };
+
+  struct Frame
+  {
+    GLuint             queries[MAX_QUERIES * 2] = {};
+    uint32_t           numQueries               = 0;
+    std::vector<Query> passes;
+    bool               pending = false;
+  };
+
+  void readBack(Frame& frame);
+  void addSample(const char* name, double milliseconds, bool fenced);
+
+  Frame    m_frames[RING_FRAMES];
+  uint32_t m_frameIndex          = 0;
+  bool     m_multiviewTimestamps = false;
+  bool     m_frameActive         = false;
+
+  std::chrono::high_resolution_clock::time_point m_fenceStart;
+
+  // running sums until AVERAGE_FRAMES frames were read back
+  struct Sum
+  {
+    std::string name;
+    double      milliseconds = 0.0;
+    uint32_t    samples      = 0;
+    bool        fenced       = false;
+  };
+  std::vector<Sum>   m_sums;
+  uint32_t           m_summedFrames = 0;
+  std::vector<Timer> m_timers;
+};
@@ -0,0 +1,671 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "MVRBenchmark.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+static const char* renderModeName(MVRSettings::RenderMode mode)
+{
+  switch(mode)
+  {
+    case MVRSettings::RenderMode::SOFTWARE_FALLBACK:
+      return "fallback";
+    case MVRSettings::RenderMode::SINGLE_PASS_STEREO:
+      return "sps";
+    case MVRSettings::RenderMode::MULTI_VIEW_RENDERING:
+      return "mvr";
+  }
+  return "unknown";
+}
+
+static const char* drawPathName(MVRSettings::DrawPath drawPath)
+{
+  switch(drawPath)
+  {
+    case MVRSettings::DrawPath::PER_OBJECT_DRAW:
+      return "perobject";
+    case MVRSettings::DrawPath::MULTI_DRAW_INDIRECT:
+      return "mdi";
+    case MVRSettings::DrawPath::INSTANCED_GRID:
+      return "instanced";
+    default:
+      break;
+  }
+  return "unknown";
+}
+
+namespace {
+// contents of a JSON string, e.g. driver strings may contain quotes or backslashes
+std::string escapeJson(const char* text)
+{
+  std::string escaped;
+  for(const char* c = text; *c; ++c)
+  {
+    if(*c == '"' || *c == '\\')
+    {
+      escaped += '\\';
+      escaped += *c;
+    }
+    else if((unsigned char)(*c) < 0x20)
+    {
+      char code[8];
+      snprintf(code, sizeof(code), "\\u%04x", unsigned(*c));
+      escaped += code;
+    }
+    else
+    {
+      escaped += *c;
+    }
+  }
+  return escaped;
+}
+
+// one line of results, written as CSV row and JSON object
+struct Row
+{
+  struct Column
+  {
+    std::string name;
+    std::string value;
+    bool        quoted;  // JSON string
+    // JSON only: member 'key' of the nested object 'object' instead of 'name', e.g. "cpu": {"mean": ...}
+    std::string object = std::string();
+    std::string key    = std::string();
+  };
+  std::vector<Column> columns;
+
+  void add(const char* name, const char* value) { columns.push_back({name, value, true}); }
+  void add(const char* name, bool value) { columns.push_back({name, value ? "true" : "false", false}); }
+  void add(const char* name, int value) { columns.push_back({name, std::to_string(value), false}); }
+  void add(const char* name, uint64_t value) { columns.push_back({name, std::to_string(value), false}); }
+  void add(const char* name, double value)
+  {
+    char text[32];
+    snprintf(text, sizeof(text), "%.4f", value);
+    columns.push_back({name, text, false});
+  }
+  // consecutive columns of the same object form one nested JSON object
+  void addNested(const char* name, const char* object, const char* key, double value)
+  {
+    add(name, value);
+    columns.back().object = object;
+    columns.back().key    = key;
+  }
+
+  void writeCsvHeader(FILE* file) const
+  {
+    for(size_t i = 0; i < columns.size(); ++i)
+    {
+      fprintf(file, "%s%s", columns[i].name.c_str(), i + 1 < columns.size() ? "," : "\n");
+    }
+  }
+  void writeCsv(FILE* file) const
+  {
+    for(size_t i = 0; i < columns.size(); ++i)
+    {
+      fprintf(file, "%s%s", columns[i].value.c_str(), i + 1 < columns.size() ? "," : "\n");
+    }
+  }
+  void writeJson(FILE* file, bool more) const
+  {
+    fprintf(file, "    {");
+    for(size_t i = 0; i < columns.size(); ++i)
+    {
+      const Column&     column    = columns[i];
+      const bool        nested    = !column.object.empty();
+      const bool        openObj   = nested && (i == 0 || columns[i - 1].object != column.object);
+      const bool        closeObj  = nested && (i + 1 == columns.size() || columns[i + 1].object != column.object);
+      const char*       quote     = column.quoted ? "\"" : "";
+      const std::string value     = column.quoted ? escapeJson(column.value.c_str()) : column.value;
+      const char*       separator = i + 1 < columns.size() ? ", " : "";
+      if(openObj)
+      {
+        fprintf(file, "\"%s\": {", column.object.c_str());
+      }
+      fprintf(file, "\"%s\": %s%s%s", nested ? column.key.c_str() : column.name.c_str(), quote, value.c_str(), quote);
+      fprintf(file, "%s%s", closeObj ? "}" : "", nested && !closeObj ? ", " : separator);
+    }
+    fprintf(file, "}%s\n", more ? "," : "");
+  }
+};
+}  // namespace
+
+static std::vector<std::string> splitList(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::stringstream        stream(list);
+  std::string              item;
+  while(std::getline(stream, item, ','))
+  {
+    if(!item.empty())
+    {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+bool MVRBenchmark::parseIntList(const std::string& list, std::vector<int>& values)
+{
+  for(const std::string& item : splitList(list))
+  {
+    values.push_back(atoi(item.c_str()));
+  }
+  return !values.empty();
+}
+
+bool MVRBenchmark::init()
+{
+  std::vector<MVRSettings::RenderMode> modes;
+  for(const std::string& item : splitList(config.modes))
+  {
+    if(item == "fallback" || item == "0")
+      modes.push_back(MVRSettings::RenderMode::SOFTWARE_FALLBACK);
+    else if(item == "sps" || item == "1")
+      modes.push_back(MVRSettings::RenderMode::SINGLE_PASS_STEREO);
+    else if(item == "mvr" || item == "2")
+      modes.push_back(MVRSettings::RenderMode::MULTI_VIEW_RENDERING);
+    else
+      LOGW("sweep: unknown render mode \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<std::pair<bool, bool>> shaderStages;  // {geometry shader, tessellation shaders}
+  for(const std::string& item : splitList(config.shaders))
+  {
+    if(item == "vs")
+      shaderStages.push_back({false, false});
+    else if(item == "gs")
+      shaderStages.push_back({true, false});
+    else if(item == "ts")
+      shaderStages.push_back({false, true});
+    else if(item == "tsgs")
+      shaderStages.push_back({true, true});
+    else
+      LOGW("sweep: unknown shader stage set \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<ObjectUpdateStrategy> updates;
+  for(const std::string& item : splitList(config.update))
+  {
+    if(item == "subdata")
+      updates.push_back(ObjectUpdateStrategy::BUFFER_SUB_DATA);
+    else if(item == "ring")
+      updates.push_back(ObjectUpdateStrategy::PERSISTENT_RING);
+    else
+      LOGW("sweep: unknown object update strategy \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<MVRSettings::DrawPath> drawPaths;
+  for(const std::string& item : splitList(config.draw))
+  {
+    if(item == "perobject")
+      drawPaths.push_back(MVRSettings::DrawPath::PER_OBJECT_DRAW);
+    else if(item == "mdi")
+      drawPaths.push_back(MVRSettings::DrawPath::MULTI_DRAW_INDIRECT);
+    else if(item == "instanced")
+      drawPaths.push_back(MVRSettings::DrawPath::INSTANCED_GRID);
+    else
+      LOGW("sweep: unknown draw path \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<Torus::VertexFormat> vertexFormats;
+  for(const std::string& item : splitList(config.vertex))
+  {
+    if(item == "float")
+      vertexFormats.push_back(Torus::VertexFormat::FLOAT32_PLANAR);
+    else if(item == "compact")
+      vertexFormats.push_back(Torus::VertexFormat::COMPACT_INTERLEAVED);
+    else
+      LOGW("sweep: unknown vertex format \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<bool> indexOrders;
+  for(const std::string& item : splitList(config.indices))
+  {
+    if(item == "naive")
+      indexOrders.push_back(false);
+    else if(item == "optimized")
+      indexOrders.push_back(true);
+    else
+      LOGW("sweep: unknown index order \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<bool> noiseSources;  // baked
+  for(const std::string& item : splitList(config.noise))
+  {
+    if(item == "procedural")
+      noiseSources.push_back(false);
+    else if(item == "baked")
+      noiseSources.push_back(true);
+    else
+      LOGW("sweep: unknown noise source \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<CullingMode> cullingModes;
+  for(const std::string& item : splitList(config.cull))
+  {
+    if(item == "off")
+      cullingModes.push_back(CullingMode::DISABLED);
+    else if(item == "cpu")
+      cullingModes.push_back(CullingMode::CPU);
+    else if(item == "gpu")
+      cullingModes.push_back(CullingMode::GPU);
+    else
+      LOGW("sweep: unknown culling mode \"%s\" ignored\n", item.c_str());
+  }
+
+  std::vector<std::pair<int, int>> tessellations;
+  for(const std::string& item : splitList(config.tess))
+  {
+    int n = 0, m = 0;
+    int parsed = sscanf(item.c_str(), "%dx%d", &n, &m);
+    if(parsed == 1)
+      m = n;
+    if(parsed >= 1)
+      tessellations.push_back({n, m});
+  }
+
+  std::vector<int> views, tori, fragLoads, msaa, multiRes, atlas, threads, lods;
+  if(modes.empty() || shaderStages.empty() || updates.empty() || drawPaths.empty() || vertexFormats.empty() || indexOrders.empty() || noiseSources.empty() || cullingModes.empty() || tessellations.empty() || !parseIntList(config.views, views)
+     || !parseIntList(config.tori, tori) || !parseIntList(config.fragLoad, fragLoads) || !parseIntList(config.msaa, msaa)
+     || !parseIntList(config.multiRes, multiRes) || !parseIntList(config.atlas, atlas) || !parseIntList(config.threads, threads) || !parseIntList(config.lods, lods))
+  {
+    LOGE("sweep: every sweep axis needs at least one valid entry\n");
+    return false;
+  }
+
+  // cartesian product of all axes, expanded one axis at a time
+  m_cells.assign(1, CellResult());
+  auto expand = [this](const auto& values, auto apply) {
+    std::vector<CellResult> expanded;
+    for(const CellResult& result : m_cells)
+    {
+      for(const auto& value : values)
+      {
+        CellResult next = result;
+        apply(next.cell, value);
+        expanded.push_back(next);
+      }
+    }
+    m_cells.swap(expanded);
+  };
+
+  expand(modes, [](Cell& cell, MVRSettings::RenderMode mode) { cell.settings.m_renderMode = mode; });
+  expand(views, [](Cell& cell, int numViews) {
+    cell.settings.m_views = numViews == 4 ? MVRSettings::Views::QUAD_VIEW : MVRSettings::Views::TWO_VIEWS;
+  });
+  expand(tori, [](Cell& cell, int numTori) { cell.numberOfTori = std::max(1, numTori); });
+  expand(tessellations, [](Cell& cell, const std::pair<int, int>& tess) {
+    cell.tessellationN = tess.first;
+    cell.tessellationM = tess.second;
+  });
+  expand(vertexFormats, [](Cell& cell, Torus::VertexFormat format) { cell.vertexFormat = format; });
+  expand(indexOrders, [](Cell& cell, bool optimize) { cell.optimizeIndices = optimize; });
+  expand(lods, [](Cell& cell, int lodCount) { cell.lodCount = std::max(1, lodCount); });
+  expand(cullingModes, [](Cell& cell, CullingMode mode) { cell.cullingMode = mode; });
+  expand(fragLoads, [](Cell& cell, int fragLoad) { cell.fragmentLoad = std::max(1, fragLoad); });
+  expand(noiseSources, [](Cell& cell, bool baked) { cell.settings.m_bakedNoise = baked; });
+  expand(msaa, [](Cell& cell, int samples) {
+    // 0: off, 1: on with the default sample count, otherwise the sample count
+    cell.settings.m_multisample = samples != 0;
+    if(samples > 1)
+      cell.settings.m_samples = uint32_t(samples);
+  });
+  expand(multiRes, [](Cell& cell, int density) {
+    // the center keeps its default size, only the border resolution is swept
+    cell.settings.m_multiRes        = density > 0 && density < 100;
+    cell.settings.m_multiResDensity = float(std::min(std::max(density, 10), 100)) / 100.0f;
+  });
+  expand(atlas, [](Cell& cell, int tileWidth) {
+    cell.settings.m_shadingAtlas = tileWidth > 0;
+    if(tileWidth > 0)
+      cell.settings.m_atlasTileWidth = uint32_t(tileWidth);
+  });
+  expand(shaderStages, [](Cell& cell, const std::pair<bool, bool>& stages) {
+    cell.settings.m_useGeometryShader     = stages.first;
+    cell.settings.m_useTessellationShader = stages.second;
+  });
+  expand(drawPaths, [](Cell& cell, MVRSettings::DrawPath drawPath) { cell.settings.m_drawPath = drawPath; });
+  expand(updates, [](Cell& cell, ObjectUpdateStrategy update) { cell.objectUpdate = update; });
+  expand(threads, [](Cell& cell, int numThreads) { cell.workerThreads = std::max(0, numThreads); });
+
+  config.warmupFrames  = std::max(0, config.warmupFrames);
+  config.measureFrames = std::max(1, config.measureFrames);
+
+  for(PendingFrame& frame : m_frames)
+  {
+    glCreateQueries(GL_TIMESTAMP, 2, frame.queries);
+    frame.pending = false;
+  }
+
+  m_currentCell = 0;
+  m_frameInCell = 0;
+  m_queryFrame  = 0;
+
+  LOGI("sweep: %d cells, %d warm-up and %d measured frames each\n", int(m_cells.size()), config.warmupFrames,
+       config.measureFrames);
+  return true;
+}
+
+void MVRBenchmark::deinit()
+{
+  for(PendingFrame& frame : m_frames)
+  {
+    if(frame.queries[0])
+    {
+      glDeleteQueries(2, frame.queries);
+      frame.queries[0] = frame.queries[1] = 0;
+    }
+  }
+}
+
+void MVRBenchmark::skipCurrentCell()
+{
+  if(isFinished())
+    return;
+
+  LOGW("sweep: cell %d not supported on this system, skipped\n", int(m_currentCell));
+  m_cells[m_currentCell].skipped = true;
+  ++m_currentCell;
+  m_frameInCell = 0;
+}
+
+void MVRBenchmark::beginFrame()
+{
+  // make room for this frame's queries
+  PendingFrame& frame = m_frames[m_queryFrame % QUERY_FRAMES];
+  if(frame.pending)
+  {
+    readBackQueries(1);
+  }
+
+  m_cpuStart = std::chrono::high_resolution_clock::now();
+  glQueryCounter(frame.queries[0], GL_TIMESTAMP);
+}
+
+void MVRBenchmark::endFrame()
+{
+  PendingFrame& frame = m_frames[m_queryFrame % QUERY_FRAMES];
+  glQueryCounter(frame.queries[1], GL_TIMESTAMP);
+
+  auto   cpuEnd = std::chrono::high_resolution_clock::now();
+  double cpuMs  = std::chrono::duration<double, std::milli>(cpuEnd - m_cpuStart).count();
+
+  frame.cell     = m_currentCell;
+  frame.measured = m_frameInCell >= config.warmupFrames;
+  frame.pending  = true;
+  ++m_queryFrame;
+
+  if(frame.measured)
+  {
+    m_cells[m_currentCell].cpuTimes.push_back(cpuMs);
+  }
+
+  readBackQueries(0);
+  advance();
+}
+
+void MVRBenchmark::setGeometryStatistics(const VertexCacheStatistics& statistics, int indexBits)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].vertexCache = statistics;
+    m_cells[m_currentCell].indexBits   = indexBits;
+  }
+}
+
+void MVRBenchmark::setLodStatistics(const std::vector<uint32_t>& toriPerLod, uint64_t triangles)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].toriPerLod = toriPerLod;
+    m_cells[m_currentCell].triangles  = triangles;
+  }
+}
+
+void MVRBenchmark::setVisibleTori(int visibleTori)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].visibleTori = visibleTori;
+  }
+}
+
+void MVRBenchmark::setGLCalls(uint32_t issued, uint32_t elided)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].glCallsIssued = issued;
+    m_cells[m_currentCell].glCallsElided = elided;
+  }
+}
+
+void MVRBenchmark::setPipelineStatistics(const PipelineStatistics::Values& values, uint32_t views, uint32_t tori)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].pipelineStatistics = values;
+    m_cells[m_currentCell].views              = std::max(views, 1u);
+    m_cells[m_currentCell].tori               = std::max(tori, 1u);
+  }
+}
+
+void MVRBenchmark::setMemoryFootprint(uint64_t bytes)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].memoryBytes = bytes;
+  }
+}
+
+void MVRBenchmark::setShadedPixels(uint64_t pixels)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].shadedPixels = pixels;
+  }
+}
+
+void MVRBenchmark::setAtlasTexels(uint64_t texels)
+{
+  if(m_currentCell < m_cells.size())
+  {
+    m_cells[m_currentCell].atlasTexels = texels;
+  }
+}
+
+void MVRBenchmark::advance()
+{
+  ++m_frameInCell;
+  if(m_frameInCell >= config.warmupFrames + config.measureFrames)
+  {
+    ++m_currentCell;
+    m_frameInCell = 0;
+  }
+}
+
+void MVRBenchmark::readBackQueries(uint32_t waitFrames)
+{
+  // oldest frames first, so results arrive in submission order;
+  // the oldest waitFrames frames are read with a blocking wait
+  for(uint32_t i = 0; i < QUERY_FRAMES; ++i)
+  {
+    PendingFrame& frame = m_frames[(m_queryFrame + i) % QUERY_FRAMES];
+    if(!frame.pending)
+      continue;
+
+    GLint available = GL_TRUE;
+    if(i >= waitFrames)
+    {
+      glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if(!available)
+      break;
+
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(frame.queries[0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(frame.queries[1], GL_QUERY_RESULT, &end);
+    if(frame.measured)
+    {
+      m_cells[frame.cell].gpuTimes.push_back(double(end - begin) / 1000000.0);
+    }
+    frame.pending = false;
+  }
+}
+
+MVRBenchmark::Statistics MVRBenchmark::computeStatistics(std::vector<double> values)
+{
+  Statistics stats;
+  if(values.empty())
+    return stats;
+
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for(double value : values)
+  {
+    sum += value;
+  }
+  stats.mean = sum / double(values.size());
+
+  // nearest-rank percentiles
+  auto percentile = [&values](double p) {
+    size_t rank = size_t(std::ceil(p / 100.0 * double(values.size())));
+    return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+  };
+  stats.p50 = percentile(50.0);
+  stats.p99 = percentile(99.0);
+  return stats;
+}
+
+void MVRBenchmark::writeResults()
+{
+  readBackQueries(QUERY_FRAMES);
+
+  std::string csvName  = config.output + ".csv";
+  std::string jsonName = config.output + ".json";
+  FILE*       csv      = fopen(csvName.c_str(), "wt");
+  FILE*       json     = fopen(jsonName.c_str(), "wt");
+  if(!csv || !json)
+  {
+    LOGE("sweep: could not open %s / %s for writing\n", csvName.c_str(), jsonName.c_str());
+    if(csv)
+      fclose(csv);
+    if(json)
+      fclose(json);
+    return;
+  }
+
+  // the driver strings are needed to compare runs across systems
+  const char* vendor   = (const char*)glGetString(GL_VENDOR);
+  const char* renderer = (const char*)glGetString(GL_RENDERER);
+  const char* version  = (const char*)glGetString(GL_VERSION);
+
+  fprintf(json, "{\n  \"vendor\": \"%s\",\n  \"renderer\": \"%s\",\n  \"version\": \"%s\",\n",
+          escapeJson(vendor ? vendor : "").c_str(), escapeJson(renderer ? renderer : "").c_str(),
+          escapeJson(version ? version : "").c_str());
+  fprintf(json, "  \"warmupFrames\": %d,\n  \"measureFrames\": %d,\n  \"results\": [\n", config.warmupFrames,
+          config.measureFrames);
+
+  for(size_t i = 0; i < m_cells.size(); ++i)
+  {
+    const CellResult& result = m_cells[i];
+    const Cell&       cell   = result.cell;
+    Statistics        cpu    = computeStatistics(result.cpuTimes);
+    Statistics        gpu    = computeStatistics(result.gpuTimes);
+
+    Row row;
+    row.add("mode", renderModeName(cell.settings.m_renderMode));
+    row.add("views", cell.settings.m_views == MVRSettings::Views::QUAD_VIEW ? 4 : 2);
+    row.add("tori", cell.numberOfTori);
+    row.add("tessN", cell.tessellationN);
+    row.add("tessM", cell.tessellationM);
+    row.add("vertexFormat", cell.vertexFormat == Torus::VertexFormat::COMPACT_INTERLEAVED ? "compact" : "float");
+    row.add("indexOrder", cell.optimizeIndices ? "optimized" : "naive");
+    row.add("indexBits", result.indexBits);
+    row.add("acmr", double(result.vertexCache.acmr));
+    row.add("atvr", double(result.vertexCache.atvr));
+    row.add("cull", cell.cullingMode == CullingMode::GPU ? "gpu" : (cell.cullingMode == CullingMode::CPU ? "cpu" : "off"));
+    row.add("visibleTori", result.visibleTori);
+    row.add("lods", cell.lodCount);
+    std::string toriPerLod;
+    for(uint32_t count : result.toriPerLod)
+    {
+      toriPerLod += (toriPerLod.empty() ? "" : "/") + std::to_string(count);
+    }
+    // -1 if unknown (GPU culling selects the levels on the GPU)
+    row.add("toriPerLod", toriPerLod.empty() ? "-1" : toriPerLod.c_str());
+    if(result.toriPerLod.empty())
+      row.add("trianglesPerPass", -1);
+    else
+      row.add("trianglesPerPass", result.triangles);
+    row.add("glCallsIssued", uint64_t(result.glCallsIssued));
+    row.add("glCallsElided", uint64_t(result.glCallsElided));
+    for(int c = 0; c < PipelineStatistics::NUM_COUNTERS; ++c)
+    {
+      // 0 without GL_ARB_pipeline_statistics_query
+      const std::string name    = PipelineStatistics::getColumnName(PipelineStatistics::Counter(c));
+      const double      perView = double(result.pipelineStatistics.counters[c]) / double(result.views);
+      row.add((name + "PerView").c_str(), result.pipelineStatistics.valid ? perView : 0.0);
+      row.add((name + "PerTorus").c_str(), result.pipelineStatistics.valid ? perView / double(result.tori) : 0.0);
+    }
+    row.add("memoryBytes", result.memoryBytes);
+    row.add("fragmentLoad", cell.fragmentLoad);
+    row.add("noise", cell.settings.m_bakedNoise ? "baked" : "procedural");
+    row.add("multisample", cell.settings.m_multisample);
+    row.add("samples", cell.settings.m_multisample ? int(cell.settings.m_samples) : 1);
+    row.add("multiResDensity", cell.settings.m_multiRes ? double(cell.settings.m_multiResDensity) : 1.0);
+    row.add("shadedPixelsPerView", result.shadedPixels);
+    row.add("shadingAtlas", cell.settings.m_shadingAtlas);
+    row.add("atlasTexels", result.atlasTexels);
+    row.add("geometryShader", cell.settings.m_useGeometryShader);
+    row.add("tessellationShader", cell.settings.m_useTessellationShader);
+    row.add("drawPath", drawPathName(cell.settings.m_drawPath));
+    row.add("objectUpdate", cell.objectUpdate == ObjectUpdateStrategy::BUFFER_SUB_DATA ? "subdata" : "ring");
+    row.add("threads", cell.workerThreads);
+    row.add("status", result.skipped ? "skipped" : "ok");
+    row.add("frames", int(result.cpuTimes.size()));
+    // the JSON keeps its original "cpu": {"mean": ...} objects
+    row.addNested("cpu_mean_ms", "cpu", "mean", cpu.mean);
+    row.addNested("cpu_p50_ms", "cpu", "p50", cpu.p50);
+    row.addNested("cpu_p99_ms", "cpu", "p99", cpu.p99);
+    row.addNested("gpu_mean_ms", "gpu", "mean", gpu.mean);
+    row.addNested("gpu_p50_ms", "gpu", "p50", gpu.p50);
+    row.addNested("gpu_p99_ms", "gpu", "p99", gpu.p99);
+
+    if(i == 0)
+    {
+      row.writeCsvHeader(csv);
+    }
+    row.writeCsv(csv);
+    row.writeJson(json, i + 1 < m_cells.size());
+  }
+
+  fprintf(json, "  ]\n}\n");
+  fclose(csv);
+  fclose(json);
+
+  LOGOK("sweep: results written to %s and %s\n", csvName.c_str(), jsonName.c_str());
+}
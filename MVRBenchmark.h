@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "FrustumCuller.h"
+#include "MVRSettings.h"
+#include "Pipeline.h"
+#include "PipelineStatistics.h"
+#include "Torus.h"
+
+#include "nvgl/base_gl.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief Headless benchmark sweep: runs every combination of the configured
+///        settings for a fixed number of frames and writes the CPU and GPU
+///        frame time statistics as CSV and JSON.
+///        Enabled from the command line with -sweep <output base path>, see README.md.
+class MVRBenchmark
+{
+public:
+  /// @brief One point of the sweep matrix.
+  struct Cell
+  {
+    MVRSettings settings;
+    int         numberOfTori  = 16;
+    int         tessellationN = 8;
+    int         tessellationM = 8;
+    int         fragmentLoad  = 1;
+
+    ObjectUpdateStrategy objectUpdate  = ObjectUpdateStrategy::PERSISTENT_RING;
+    int                  workerThreads = 1;  // 0: all hardware threads
+
+    Torus::VertexFormat vertexFormat    = Torus::VertexFormat::FLOAT32_PLANAR;
+    bool                optimizeIndices = true;
+    int                 lodCount        = 1;
+    CullingMode         cullingMode     = CullingMode::CPU;
+  };
+
+  /// @brief Sweep axes as comma separated lists, filled from the command line.
+  struct Config
+  {
+    std::string output;                      // base path, ".csv" and ".json" get appended
+    std::string modes     = "fallback,sps,mvr";
+    std::string views     = "2,4";
+    std::string tori      = "16,256,1000";
+    std::string tess      = "8,32";          // "N" or "NxM"
+    std::string fragLoad  = "1";
+    std::string noise     = "procedural";    // any of procedural,baked
+    std::string msaa      = "0";
+    std::string multiRes  = "100";           // border density in percent, 100 renders the full resolution
+    std::string atlas     = "0";             // shading atlas tile widths in texels, 0 shades every view
+    std::string shaders   = "vs";            // any of vs,gs,ts,tsgs
+    std::string update    = "ring";          // any of subdata,ring
+    std::string draw      = "perobject";     // any of perobject,mdi,instanced
+    std::string vertex    = "float";         // any of float,compact
+    std::string indices   = "optimized";     // any of naive,optimized
+    std::string lods      = "1";             // torus levels of detail
+    std::string cull      = "cpu";           // any of off,cpu,gpu
+    std::string threads   = "1";             // worker threads, 0 uses all hardware threads
+    int         warmupFrames  = 30;
+    int         measureFrames = 100;
+  } config;
+
+  /// @brief True if a sweep was requested on the command line.
+  bool isEnabled() const { return !config.output.empty(); }
+
+  /// @brief Builds the sweep matrix and creates the timer queries. Returns false on invalid configuration.
+  bool init();
+  void deinit();
+
+  /// @brief The cell to render this frame, nullptr once the sweep is done.
+  const Cell* getCurrentCell() const { return m_currentCell < m_cells.size() ? &m_cells[m_currentCell].cell : nullptr; }
+
+  /// @brief Called if the current cell is not supported on this system (e.g. no MVR support).
+  void skipCurrentCell();
+
+  /// @brief Bracket the measured work of one frame.
+  void beginFrame();
+  void endFrame();
+
+  /// @brief Records the torus index buffer properties of the current cell, call before endFrame().
+  void setGeometryStatistics(const VertexCacheStatistics& statistics, int indexBits);
+  /// @brief Records the tori drawn with each level of detail and the resulting triangles per pass, call before endFrame().
+  ///        An empty toriPerLod means both are unknown (GPU culling).
+  void setLodStatistics(const std::vector<uint32_t>& toriPerLod, uint64_t triangles);
+  /// @brief Records the tori visible in at least one view, call before endFrame().
+  void setVisibleTori(int visibleTori);
+  /// @brief Records the GL binds issued and elided by the state cache in the last complete frame, call before endFrame().
+  void setGLCalls(uint32_t issued, uint32_t elided);
+  /// @brief Records the shader stage work of the scene pass normalized per view and per drawn torus (tori: the
+  ///        visible ones after culling), call before endFrame().
+  void setPipelineStatistics(const PipelineStatistics::Values& values, uint32_t views, uint32_t tori);
+  /// @brief Records the bytes of all textures and buffers of the demo (see MemoryReport), call before endFrame().
+  void setMemoryFootprint(uint64_t bytes);
+  /// @brief Records the pixels rendered per view (less than the view with multi-resolution), call before endFrame().
+  void setShadedPixels(uint64_t pixels);
+  /// @brief Records the texels of the shading atlas (0 without texture-space shading), call before endFrame().
+  void setAtlasTexels(uint64_t texels);
+
+  bool isFinished() const { return m_currentCell >= m_cells.size(); }
+
+  /// @brief Waits for outstanding queries and writes <output>.csv and <output>.json.
+  void writeResults();
+
+private:
+  struct Statistics
+  {
+    double mean = 0.0;
+    double p50  = 0.0;
+    double p99  = 0.0;
+  };
+
+  struct CellResult
+  {
+    Cell                cell;
+    bool                skipped = false;
+
+    VertexCacheStatistics vertexCache;
+    int                   indexBits = 0;
+    std::vector<uint32_t> toriPerLod;  // of the last frame, empty if unknown (GPU culling)
+    uint64_t              triangles     = 0;
+    int                   visibleTori   = 0;  // of the last frame, -1 if unknown (GPU culling)
+    uint32_t              glCallsIssued = 0;  // binds of the last frame, see GLStateCache
+    uint32_t              glCallsElided = 0;
+    // of the last frame read back, divided by views and tori when written
+    PipelineStatistics::Values pipelineStatistics;
+    uint32_t                   views = 1;
+    uint32_t                   tori  = 1;  // drawn, the visible ones if known
+    uint64_t            memoryBytes  = 0;  // textures and buffers of the last frame
+    uint64_t            shadedPixels = 0;  // per view
+    uint64_t            atlasTexels  = 0;
+    std::vector<double> cpuTimes;          // ms
+    std::vector<double> gpuTimes;          // ms
+  };
+
+  // timestamp queries are read back a few frames later to not stall the pipeline
+  static const uint32_t QUERY_FRAMES = 4;
+  struct PendingFrame
+  {
+    GLuint  queries[2] = {0, 0};
+    size_t  cell       = 0;
+    bool    measured   = false;
+    bool    pending    = false;
+  };
+
+  void        readBackQueries(uint32_t waitFrames);
+  void        advance();
+  static bool parseIntList(const std::string& list, std::vector<int>& values);
+  static Statistics computeStatistics(std::vector<double> values);
+
+  std::vector<CellResult> m_cells;
+  size_t                  m_currentCell  = 0;
+  int                     m_frameInCell  = 0;
+  uint32_t                m_queryFrame   = 0;
+  PendingFrame            m_frames[QUERY_FRAMES];
+
+  std::chrono::high_resolution_clock::time_point m_cpuStart;
+};
@@ -19,6 +19,8 @@
 
 #include "MVRDemo.h"
 
+#include "nvpsystem.hpp"
+
 typedef void(APIENTRYP PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC)(GLenum  target,
                                                                 GLenum  attachment,
                                                                 GLuint  texture,
@@ -31,27 +33,186 @@ bool MVRDemo::begin()
 {
   if(!GLToriDemo::begin())
     return false;
-  m_pipeline = std::make_unique<MVRPipeline>();
+  m_pipeline = std::make_unique<MVRPipeline>(m_useProgramCache ? NVPSystem::exePath() + "programcache" : std::string());
+  CpuTrace::setEnabled(m_cpuTrace);
+  // measured frames must not render with a fallback program
+  m_pipeline->setWaitForPrograms(m_benchmark.isEnabled());
 
   m_torus.setVertexAttributeLocations(VERTEX_POS, VERTEX_NORMAL);
 
-  nvgl::newFramebuffer(m_fbo);
-  nvgl::newFramebuffer(m_blitFbo);
-
   glFramebufferTextureMultiviewOVR =
       (PFNGLFRAMEBUFFERTEXTUREMULTIVIEWOVRPROC)nvgl::ContextWindow::sysGetProcAddress("glFramebufferTextureMultiviewOVR");
 
-  return glFramebufferTextureMultiviewOVR != nullptr;
+  // without the entry point only the other render modes are available (e.g. on Mesa llvmpipe)
+  if(glFramebufferTextureMultiviewOVR == nullptr)
+  {
+    m_pipeline->supportMVR = false;
+  }
+
+  // the multisample textures limit the sample count, not only the renderbuffers
+  GLint maxSamples = 0, maxColorSamples = 0, maxDepthSamples = 0;
+  glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+  glGetIntegerv(GL_MAX_COLOR_TEXTURE_SAMPLES, &maxColorSamples);
+  glGetIntegerv(GL_MAX_DEPTH_TEXTURE_SAMPLES, &maxDepthSamples);
+  m_maxSamples = uint32_t(std::max(0, std::min(maxSamples, std::min(maxColorSamples, maxDepthSamples))));
+
+  m_gpuTimers.setMultiviewTimestamps(m_pipeline->supportMVR_timer_query);
+  if(m_pipeline->supportPipelineStatistics)
+  {
+    m_pipelineStatistics.init();
+  }
+
+  // GPU culling writes commands for multi draw indirect, which needs GL_ARB_shader_draw_parameters
+  if(m_pipeline->supportDrawParameters && !m_gpuCuller.init(m_pipeline->supportIndirectParameters))
+  {
+    LOGW("GPU culling is not available, culling on the CPU instead\n");
+  }
+
+  if(!m_compositor.init())
+  {
+    return false;
+  }
+
+  // without the atlas every view shades the tori on its own
+  m_shadingAtlasValid = m_shadingAtlas.init();
+  if(!m_shadingAtlasValid)
+  {
+    LOGW("Texture-space shading is not available\n");
+  }
+
+  // without the volume the shaders evaluate the noise
+  m_noiseVolumeValid = m_noiseVolume.init();
+  if(!m_noiseVolumeValid)
+  {
+    LOGW("Baked noise is not available\n");
+  }
+
+  if(m_benchmark.isEnabled() && !m_benchmark.init())
+  {
+    return false;
+  }
+
+  if(m_transformBenchmarkObjects > 0)
+  {
+    BatchTransform::runMicrobenchmark(uint32_t(m_transformBenchmarkObjects), 200);
+  }
+
+  return true;
+}
+
+void MVRDemo::setupConfigParameters()
+{
+  m_parameterList.add("sweep|run a benchmark sweep and write <arg>.csv and <arg>.json", &m_benchmark.config.output);
+  m_parameterList.add("sweepmodes|comma separated render modes: fallback,sps,mvr", &m_benchmark.config.modes);
+  m_parameterList.add("sweepviews|comma separated view counts: 2,4", &m_benchmark.config.views);
+  m_parameterList.add("sweeptori|comma separated tori counts", &m_benchmark.config.tori);
+  m_parameterList.add("sweeptess|comma separated torus tessellations: N or NxM", &m_benchmark.config.tess);
+  m_parameterList.add("sweepfragload|comma separated fragment loads", &m_benchmark.config.fragLoad);
+  m_parameterList.add("sweepmsaa|comma separated sample counts, 0: off, 1: default (4), e.g. 0,2,4,8", &m_benchmark.config.msaa);
+  m_parameterList.add("sweepmultires|comma separated multi-resolution border densities in percent, 100: off", &m_benchmark.config.multiRes);
+  m_parameterList.add("sweepatlas|comma separated shading atlas tile widths in texels, 0: off, e.g. 0,64,256", &m_benchmark.config.atlas);
+  m_parameterList.add("sweepshaders|comma separated shader stages: vs,gs,ts,tsgs", &m_benchmark.config.shaders);
+  m_parameterList.add("sweepdraw|comma separated draw paths: perobject,mdi,instanced", &m_benchmark.config.draw);
+  m_parameterList.add("sweepvertex|comma separated vertex formats: float,compact", &m_benchmark.config.vertex);
+  m_parameterList.add("sweepindices|comma separated torus index orders: naive,optimized", &m_benchmark.config.indices);
+  m_parameterList.add("sweepnoise|comma separated noise sources: procedural,baked", &m_benchmark.config.noise);
+  m_parameterList.add("sweeplods|comma separated torus level of detail counts", &m_benchmark.config.lods);
+  m_parameterList.add("sweepcull|comma separated frustum culling modes: off,cpu,gpu", &m_benchmark.config.cull);
+  m_parameterList.add("sweepupdate|comma separated object data uploads: subdata,ring", &m_benchmark.config.update);
+  m_parameterList.add("sweepthreads|comma separated worker thread counts, 0 uses all hardware threads", &m_benchmark.config.threads);
+  m_parameterList.add("sweepwarmup|warm-up frames per sweep cell", &m_benchmark.config.warmupFrames);
+  m_parameterList.add("sweepframes|measured frames per sweep cell", &m_benchmark.config.measureFrames);
+  m_parameterList.add("programcache|0: compile all programs from source, 1: load unchanged programs from the binary cache (default)",
+                      &m_useProgramCache);
+  m_parameterList.add("trace|record CPU zones, written as Chrome trace JSON with F9 or next to the sweep results", &m_cpuTrace);
+  m_parameterList.add("threads|worker threads for the per torus data, 0 uses all hardware threads", &m_workerThreads);
+  m_parameterList.add("transformbench|time the per torus transform kernels for <arg> tori, then exit", &m_transformBenchmarkObjects);
+}
+
+void MVRDemo::onFrameBegin()
+{
+  if(!m_benchmark.isEnabled() || m_benchmark.isFinished())
+  {
+    return;
+  }
+
+  // apply the next sweep cell, skipping the ones this system can't render as requested
+  while(const MVRBenchmark::Cell* cell = m_benchmark.getCurrentCell())
+  {
+    m_settings = cell->settings;
+    validateSettings();
+    const int maxTori = m_settings.m_drawPath == MVRSettings::DrawPath::PER_OBJECT_DRAW ? MAX_TORI_PER_OBJECT_DRAW : MAX_TORI;
+    if(m_settings == cell->settings && cell->numberOfTori <= maxTori)
+    {
+      m_numberOfTori         = cell->numberOfTori;
+      m_fragmentLoad         = cell->fragmentLoad;
+      m_objectUpdateStrategy = cell->objectUpdate;
+      m_workerThreads        = cell->workerThreads;
+      m_torus.setTessellation(cell->tessellationN, cell->tessellationM);
+      m_torus.setVertexFormat(cell->vertexFormat);
+      m_torus.setOptimizeIndices(cell->optimizeIndices);
+      m_torus.setLodCount(cell->lodCount);
+      m_cullingMode = cell->cullingMode;
+      break;
+    }
+    m_benchmark.skipCurrentCell();
+  }
+
+  if(!m_benchmark.isFinished())
+  {
+    m_benchmark.beginFrame();
+    m_benchmarkFrameActive = true;
+  }
+}
+
+void MVRDemo::onFrameEnd()
+{
+  if(m_benchmarkFrameActive)
+  {
+    m_benchmark.setGeometryStatistics(m_torus.getVertexCacheStatistics(), m_torus.getIndexType() == GL_UNSIGNED_SHORT ? 16 : 32);
+    // with GPU culling the CPU counts every torus at the finest level
+    const bool gpuCulling = usesGpuCulling(m_settings.m_drawPath);
+    m_benchmark.setLodStatistics(gpuCulling ? std::vector<uint32_t>() : m_lodDrawCounts, m_lodTriangles);
+    m_benchmark.setVisibleTori(gpuCulling ? -1 : int(m_visibleTori));
+    m_benchmark.setPipelineStatistics(m_pipelineStatistics.getValues(), m_settings.m_views == MVRSettings::Views::QUAD_VIEW ? 4 : 2,
+                                      getDrawnTori());
+    m_benchmark.setGLCalls(GLStateCache::get().getFrameCounters().issued, GLStateCache::get().getFrameCounters().elided);
+    MemoryReport memory;
+    reportMemory(memory);
+    m_benchmark.setMemoryFootprint(memory.getTotal());
+    m_benchmark.setShadedPixels(uint64_t(m_targetWidth) * uint64_t(m_targetHeight));
+    m_benchmark.setAtlasTexels(m_settings.m_shadingAtlas ? m_shadingAtlas.getTexels() : 0);
+    m_benchmark.endFrame();
+    m_benchmarkFrameActive = false;
+  }
+
+  if(m_benchmark.isEnabled() && m_benchmark.isFinished())
+  {
+    m_benchmark.writeResults();
+    if(CpuTrace::isEnabled())
+    {
+      CpuTrace::writeChromeTrace(m_benchmark.config.output + ".trace.json");
+    }
+    m_benchmark.config.output.clear();
+    close();
+  }
+
+  if(m_transformBenchmarkObjects > 0)
+  {
+    close();
+  }
 }
 
 void MVRDemo::initTextures(uint32_t width, uint32_t height, bool forceReInit)
 {
-  GLsizei oldWidth  = m_perViewWidth;
-  GLsizei oldHeight = m_perViewHeight;
+  GLsizei oldWidth  = m_targetWidth;
+  GLsizei oldHeight = m_targetHeight;
 
   // width & height are the window dimensions, the rendering dimensions
   // depend on whether 2 vs 4 views should be rendered:
   m_perViewWidth = width / 2;
+  // only as many layers as views, e.g. two views need half the memory of four
+  const GLsizei numViews = m_settings.m_views == MVRSettings::Views::QUAD_VIEW ? 4 : 2;
   if(m_settings.m_views == MVRSettings::Views::QUAD_VIEW)
   {
     m_perViewHeight = height / 2;
@@ -61,50 +222,128 @@ void MVRDemo::initTextures(uint32_t width, uint32_t height, bool forceReInit)
     m_perViewHeight = height;
   }
 
+  // the multi-resolution cells fit into a smaller target, the projection and the LOD selection keep the full view size
+  m_targetWidth  = m_perViewWidth;
+  m_targetHeight = m_perViewHeight;
+  if(m_settings.m_multiRes)
+  {
+    m_multiResLayout.update(m_perViewWidth, m_perViewHeight, m_settings.m_multiResCenter, m_settings.m_multiResDensity);
+    m_targetWidth  = m_multiResLayout.width;
+    m_targetHeight = m_multiResLayout.height;
+  }
+
   if(!forceReInit)
   {
     // check if a re-init is not needed because the relevant settings didn't change
-    if(oldWidth == m_perViewWidth && oldHeight == m_perViewHeight && m_settings.m_multisample == m_texturesAreMultisample)
+    if(oldWidth == m_targetWidth && oldHeight == m_targetHeight && m_settings.m_multisample == m_texturesAreMultisample
+       && (!m_settings.m_multisample || GLsizei(m_settings.m_samples) == m_textureSamples) && numViews == m_textureLayers)
     {
       return;
     }
   }
 
-  nvgl::deleteTexture(m_colorTexArray);
-  nvgl::deleteTexture(m_depthTexArray);
+  const GLuint oldColorTexArray = m_colorTexArray;
+  const GLuint oldDepthTexArray = m_depthTexArray;
+
+  // the pool hands out the same textures again as long as the new size fits them
+  m_renderTargets.release(m_colorTexArray);
+  m_renderTargets.release(m_depthTexArray);
+  m_renderTargets.release(m_resolveTexArray);
+
+  const GLsizei samples = m_settings.m_multisample ? GLsizei(m_settings.m_samples) : 0;
 
-  GLsizei samples = 4;
+  RenderTargetPool::Desc desc;
+  desc.width   = m_targetWidth;
+  desc.height  = m_targetHeight;
+  desc.layers  = numViews;
+  desc.samples = samples;
+  desc.format  = GL_RGBA8;
+  m_colorTexArray = m_renderTargets.acquire(desc);
+  desc.format     = GL_DEPTH_COMPONENT24;
+  m_depthTexArray = m_renderTargets.acquire(desc);
+
+  m_resolveTexArray = 0;
+  if(samples)
+  {
+    // written by the resolve dispatch, read by the composition
+    desc.samples      = 0;
+    desc.format       = GL_RGBA8;
+    m_resolveTexArray = m_renderTargets.acquire(desc);
+  }
+  m_texturesAreMultisample = m_settings.m_multisample;
+  m_textureSamples         = samples;
+  m_textureLayers          = numViews;
 
-  if(m_settings.m_multisample == true)
+  if(forceReInit || m_colorTexArray != oldColorTexArray || m_depthTexArray != oldDepthTexArray)
   {
-    nvgl::newTexture(m_colorTexArray, GL_TEXTURE_2D_MULTISAMPLE_ARRAY);
-    nvgl::newTexture(m_depthTexArray, GL_TEXTURE_2D_MULTISAMPLE_ARRAY);
+    initFramebuffers();
+  }
+}
 
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE_ARRAY, m_colorTexArray);
-    glTexImage3DMultisample(GL_TEXTURE_2D_MULTISAMPLE_ARRAY, samples, GL_RGBA8, m_perViewWidth, m_perViewHeight, MAX_VIEWS, GL_FALSE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE_ARRAY, m_depthTexArray);
-    glTexImage3DMultisample(GL_TEXTURE_2D_MULTISAMPLE_ARRAY, samples, GL_DEPTH_COMPONENT24, m_perViewWidth,
-                            m_perViewHeight, MAX_VIEWS, GL_FALSE);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE_ARRAY, 0);
+void MVRDemo::initFramebuffers()
+{
+  GLStateCache& state = GLStateCache::get();
+
+  // software fallback: one layer per framebuffer
+  for(GLuint& framebuffer : m_viewFramebuffers.layers)
+  {
+    state.deleteFramebuffer(framebuffer);
   }
-  else
+  for(GLint i = 0; i < m_textureLayers; ++i)
   {
-    nvgl::newTexture(m_colorTexArray, GL_TEXTURE_2D_ARRAY);
-    nvgl::newTexture(m_depthTexArray, GL_TEXTURE_2D_ARRAY);
-    glTextureStorage3D(m_colorTexArray, 1, GL_RGBA8, m_perViewWidth, m_perViewHeight, MAX_VIEWS);
-    glTextureStorage3D(m_depthTexArray, 1, GL_DEPTH_COMPONENT24, m_perViewWidth, m_perViewHeight, MAX_VIEWS);
+    state.newFramebuffer(m_viewFramebuffers.layers[i]);
+    glNamedFramebufferTextureLayer(m_viewFramebuffers.layers[i], GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, i);
+    glNamedFramebufferTextureLayer(m_viewFramebuffers.layers[i], GL_DEPTH_ATTACHMENT, m_depthTexArray, 0, i);
   }
-  m_texturesAreMultisample = m_settings.m_multisample;
 
-  LOGOK("texture (re)init done\n");
+  // Single Pass Stereo: all layers, the second view is routed to layer 1
+  state.newFramebuffer(m_viewFramebuffers.layered);
+  glNamedFramebufferTexture(m_viewFramebuffers.layered, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0);
+  glNamedFramebufferTexture(m_viewFramebuffers.layered, GL_DEPTH_ATTACHMENT, m_depthTexArray, 0);
+
+  // Multi-View Rendering: all layers, the extension has no DSA entry point
+  state.deleteFramebuffer(m_viewFramebuffers.multiview);
+  if(m_pipeline->supportMVR && (!m_texturesAreMultisample || m_pipeline->supportMVR_texture_multisample))
+  {
+    state.newFramebuffer(m_viewFramebuffers.multiview);
+    state.bindFramebuffer(GL_FRAMEBUFFER, m_viewFramebuffers.multiview);
+    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 0, m_textureLayers);
+    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexArray, 0, 0, m_textureLayers);
+  }
+
+  LOGOK("view framebuffers (re)init done\n");
+}
+
+void MVRDemo::deinitFramebuffers()
+{
+  for(GLuint& framebuffer : m_viewFramebuffers.layers)
+  {
+    GLStateCache::get().deleteFramebuffer(framebuffer);
+  }
+  GLStateCache::get().deleteFramebuffer(m_viewFramebuffers.layered);
+  GLStateCache::get().deleteFramebuffer(m_viewFramebuffers.multiview);
+}
+
+void MVRDemo::reportMemory(MemoryReport& report) const
+{
+  GLToriDemo::reportMemory(report);
+  m_renderTargets.reportMemory(report, "MVRDemo");
+  m_shadingAtlas.reportMemory(report);
+  m_noiseVolume.reportMemory(report);
 }
 
 void MVRDemo::end()
 {
-  nvgl::deleteTexture(m_colorTexArray);
-  nvgl::deleteTexture(m_depthTexArray);
-  nvgl::deleteFramebuffer(m_fbo);
-  nvgl::deleteFramebuffer(m_blitFbo);
+  m_benchmark.deinit();
+  m_pipelineStatistics.deinit();
+  deinitFramebuffers();
+  m_renderTargets.deinit();
+  m_colorTexArray   = 0;
+  m_depthTexArray   = 0;
+  m_resolveTexArray = 0;
+  m_compositor.deinit();
+  m_shadingAtlas.deinit();
+  m_noiseVolume.deinit();
   GLToriDemo::end();
 }
 
@@ -113,20 +352,13 @@ void MVRDemo::renderFrame(double time, uint32_t width, uint32_t height, GLuint f
   static bool firstRun = true;
 
   validateSettings();
+  m_renderTargets.beginFrame();
   initTextures(width, height, firstRun);
   firstRun = false;
 
-  // Track the GPU frame time. This is only defined during multi-view rendering
-  // if GL_EXT_multiview_timer_query is available.
-  const bool timerQueryDefined =
-      m_pipeline->supportMVR_timer_query || (m_settings.m_renderMode != MVRSettings::RenderMode::MULTI_VIEW_RENDERING);
-  std::unique_ptr<nvgl::ProfilerGL::Section> gpuTimer;
-  if(timerQueryDefined)
-  {
-    gpuTimer = std::make_unique<nvgl::ProfilerGL::Section>(m_profilerGL, "Whole Frame");
-  }
-
-  glViewport(0, 0, m_perViewWidth, m_perViewHeight);
+  glViewport(0, 0, m_targetWidth, m_targetHeight);
+  // the composition and the UI render without depth test
+  glEnable(GL_DEPTH_TEST);
 
   if(m_settings.m_multisample)
   {
@@ -142,12 +374,75 @@ void MVRDemo::renderFrame(double time, uint32_t width, uint32_t height, GLuint f
     glPatchParameteri(GL_PATCH_VERTICES, 3);
   }
 
-  updatePerFrameUniforms(m_perViewWidth, m_perViewHeight);
-  m_pipeline->setSettings(m_settings);
-  m_pipeline->setShaderProgram();
+  {
+    CPU_TRACE_ZONE("updatePerFrameUniforms");
+    updatePerFrameUniforms(m_perViewWidth, m_perViewHeight);
+  }
+  {
+    CPU_TRACE_ZONE("setSettings");
+    m_pipeline->setSettings(m_settings);
+  }
+
+  // the visibility and the level of detail of each torus depend on all views rendered this frame
+  const size_t viewsThisFrame = m_settings.m_views == MVRSettings::QUAD_VIEW ? 4 : 2;
+  m_sceneViews.resize(viewsThisFrame);
+  for(size_t i = 0; i < viewsThisFrame; ++i)
+  {
+    m_sceneViews[i] = {m_pipeline->sceneData.viewMatrix[i], m_pipeline->sceneData.projMatrix[i]};
+  }
+  m_viewportHeight = float(m_perViewHeight);
+  updateTori(m_numberOfTori, m_settings.m_drawPath);
+
+  // the tori layout is known after updateTori()
+  m_pipeline->sceneData.torusScale = m_torus_scale;
+  m_pipeline->sceneData.gridOrigin = glm::vec4(m_toriGrid.x0, m_toriGrid.y0, m_toriGrid.dx, m_toriGrid.dy);
+  m_pipeline->sceneData.gridSize   = glm::ivec4(m_toriGrid.numX, m_toriGrid.numY, m_numberOfTori, 0);
+
+  const bool compactVertices = m_torus.getVertexFormat() == Torus::VertexFormat::COMPACT_INTERLEAVED;
+  m_pipeline->sceneData.vertexDecode = glm::vec4(m_torus.getPositionScale(), compactVertices ? 1.0f : 0.0f);
+  m_pipeline->sceneData.torusShape   = glm::vec4(m_torus.getInnerRadius(), m_torus.getOuterRadius(), 0.0f, 0.0f);
+
+  if(m_settings.m_shadingAtlas)
+  {
+    m_shadingAtlas.update(uint32_t(m_numberOfTori), m_settings.m_atlasTileWidth);
+    m_pipeline->sceneData.atlasLayout = m_shadingAtlas.getLayout();
+  }
+
   m_pipeline->updateSceneUniforms();
+
+  if(m_settings.m_bakedNoise)
+  {
+    // for the shading atlas and the scene passes
+    m_noiseVolume.bindTexture();
+  }
+
+  if(m_settings.m_shadingAtlas)
+  {
+    // the view independent shading of all views at once, the scene passes only add the specular term
+    uint32_t timer = m_gpuTimers.begin("Shade atlas");
+    m_shadingAtlas.shade(uint32_t(viewsThisFrame), m_settings.m_bakedNoise);
+    m_gpuTimers.end(timer);
+    m_shadingAtlas.bindTexture();
+
+    glViewport(0, 0, m_targetWidth, m_targetHeight);
+    glEnable(GL_DEPTH_TEST);
+  }
+
+  // the software fallback renders the views one by one, each with the tori visible in that view
+  uint32_t timer = m_gpuTimers.begin("Culling");
+  cullToriOnGPU(m_numberOfTori, m_settings.m_drawPath, m_settings.m_renderMode == MVRSettings::RenderMode::SOFTWARE_FALLBACK);
+  m_gpuTimers.end(timer);
+
+  {
+    CPU_TRACE_ZONE("setShaderProgram");
+    m_pipeline->setShaderProgram();
+  }
   renderToTexture();
-  blitToFramebuffer(fbo);
+
+  {
+    CPU_TRACE_ZONE("Compose views");
+    composeViews(fbo);
+  }
 }
 
 void MVRDemo::renderToTexture()
@@ -159,93 +454,145 @@ void MVRDemo::renderToTexture()
   }
   float     depth      = 1.0f;
   glm::vec4 background = glm::vec4(118.f / 255.f, 185.f / 255.f, 0.f / 255.f, 0.f / 255.f);
-
-  // not using the extension here to present a fallback and performance baseline
-  // here we fill the texture layers one by one, rendering two or four times
-  //
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+  // the depth isn't read after the scene pass, invalidating it saves writing it back to memory
+  const GLenum depthAttachment = GL_DEPTH_ATTACHMENT;
 
   GLenum primitiveMode = GL_TRIANGLES;
-  if(m_settings.m_useTessellationShader)
+  if(m_pipeline->usesTessellation())
   {
     primitiveMode = GL_PATCHES;
   }
 
+  m_pipelineStatistics.begin();
   if(m_settings.m_renderMode == MVRSettings::RenderMode::SOFTWARE_FALLBACK)
   {
+    // not using the extension here to present a fallback and performance baseline
+    // here we fill the texture layers one by one, rendering two or four times
+    static const char* viewPassNames[] = {"Scene view 0", "Scene view 1", "Scene view 2", "Scene view 3"};
     for(GLint i = 0; i < viewsThisFrame; ++i)
     {
-      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, i);
-      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexArray, 0, i);
+      GLStateCache::get().bindFramebuffer(GL_FRAMEBUFFER, m_viewFramebuffers.layers[i]);
 
+      uint32_t timer = m_gpuTimers.begin("Clear");
       glClearBufferfv(GL_COLOR, 0, &background[0]);
       glClearBufferfv(GL_DEPTH, 0, &depth);
+      m_gpuTimers.end(timer);
 
       glUniform1i(OFFSET_FALLBACK_ID, i);
 
-      renderTori(m_numberOfTori, primitiveMode);
+      // only the tori visible in this view
+      timer = m_gpuTimers.begin(viewPassNames[i]);
+      renderScene(primitiveMode, 1u << i);
+      m_gpuTimers.end(timer);
+
+      glInvalidateNamedFramebufferData(m_viewFramebuffers.layers[i], 1, &depthAttachment);
     }
   }
   else if(m_settings.m_renderMode == MVRSettings::RenderMode::SINGLE_PASS_STEREO)
   {
-
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0);
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexArray, 0);
+    GLStateCache::get().bindFramebuffer(GL_FRAMEBUFFER, m_viewFramebuffers.layered);
+    uint32_t timer = m_gpuTimers.begin("Clear");
     glClearBufferfv(GL_COLOR, 0, &background[0]);
     glClearBufferfv(GL_DEPTH, 0, &depth);
+    m_gpuTimers.end(timer);
+
+    timer = m_gpuTimers.begin("Scene");
+    renderScene(primitiveMode);
+    m_gpuTimers.end(timer);
 
-    renderTori(m_numberOfTori, primitiveMode);
+    glInvalidateNamedFramebufferData(m_viewFramebuffers.layered, 1, &depthAttachment);
   }
   else if(m_settings.m_renderMode == MVRSettings::RenderMode::MULTI_VIEW_RENDERING)
   {
-    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 0, (GLsizei)viewsThisFrame);
-    glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexArray, 0, 0, (GLsizei)viewsThisFrame);
+    GLStateCache::get().bindFramebuffer(GL_FRAMEBUFFER, m_viewFramebuffers.multiview);
+    // timestamps are only defined with a multiview framebuffer bound if GL_EXT_multiview_timer_query is supported
+    uint32_t timer = m_gpuTimers.begin("Clear", true);
     glClearBufferfv(GL_COLOR, 0, &background[0]);
     glClearBufferfv(GL_DEPTH, 0, &depth);
+    m_gpuTimers.end(timer);
 
-    renderTori(m_numberOfTori, primitiveMode);
+    timer = m_gpuTimers.begin("Scene", true);
+    renderScene(primitiveMode);
+    m_gpuTimers.end(timer);
+
+    glInvalidateNamedFramebufferData(m_viewFramebuffers.multiview, 1, &depthAttachment);
   }
   else
   {
     assert(0);
   }
+  m_pipelineStatistics.end();
 }
 
-void MVRDemo::blitToFramebuffer(GLuint fbo)
+void MVRDemo::renderScene(GLenum primitiveMode, uint32_t viewMask)
 {
-
-  // blit the texture layers onto the screen:
-  // differs only between a 2 view rendering vs a 4 view rendering
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_blitFbo);
-  glNamedFramebufferTextureLayer(m_blitFbo, GL_DEPTH_ATTACHMENT, m_depthTexArray, 0, 0);
-
-  if(m_settings.m_views == MVRSettings::Views::TWO_VIEWS)
+  if(!m_settings.m_multiRes)
   {
-    glNamedFramebufferTextureLayer(m_blitFbo, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 0);
-    glBlitFramebuffer(0, 0, m_perViewWidth, m_perViewHeight, 0, 0, m_perViewWidth, m_perViewHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    renderTori(m_numberOfTori, primitiveMode, m_settings.m_drawPath, viewMask);
+    return;
+  }
 
-    glNamedFramebufferTextureLayer(m_blitFbo, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 1);
-    glBlitFramebuffer(0, 0, m_perViewWidth, m_perViewHeight, m_perViewWidth, 0, 2 * m_perViewWidth, m_perViewHeight,
-                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  // only around the draws, the clears have to cover the whole target
+  glEnable(GL_SCISSOR_TEST);
+  if(m_pipeline->supportViewportArray2)
+  {
+    // one pass, the shaders write the viewport mask of all cells
+    glViewportArrayv(0, MULTIRES_VIEWPORTS, &m_multiResLayout.viewports[0][0]);
+    glScissorArrayv(0, MULTIRES_VIEWPORTS, &m_multiResLayout.scissors[0][0]);
+    renderTori(m_numberOfTori, primitiveMode, m_settings.m_drawPath, viewMask);
   }
   else
   {
-    glNamedFramebufferTextureLayer(m_blitFbo, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 0);
-    glBlitFramebuffer(0, 0, m_perViewWidth, m_perViewHeight, 0, 0, m_perViewWidth, m_perViewHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    // the geometry is submitted once per cell
+    for(uint32_t cell = 0; cell < MULTIRES_VIEWPORTS; ++cell)
+    {
+      glViewportIndexedfv(0, m_multiResLayout.viewports[cell]);
+      glScissorIndexedv(0, m_multiResLayout.scissors[cell]);
+      renderTori(m_numberOfTori, primitiveMode, m_settings.m_drawPath, viewMask);
+    }
+  }
+  glDisable(GL_SCISSOR_TEST);
+  // sets all viewports
+  glViewport(0, 0, m_targetWidth, m_targetHeight);
+}
 
-    glNamedFramebufferTextureLayer(m_blitFbo, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 1);
-    glBlitFramebuffer(0, 0, m_perViewWidth, m_perViewHeight, m_perViewWidth, 0, 2 * m_perViewWidth, m_perViewHeight,
-                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+void MVRDemo::composeViews(GLuint fbo)
+{
+  const uint32_t numViews = m_settings.m_views == MVRSettings::Views::QUAD_VIEW ? 4 : 2;
 
-    glNamedFramebufferTextureLayer(m_blitFbo, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 2);
-    glBlitFramebuffer(0, 0, m_perViewWidth, m_perViewHeight, 0, m_perViewHeight, m_perViewWidth, 2 * m_perViewHeight,
-                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  // the multiview framebuffer of the scene pass may still be bound, timestamps are not defined with it
+  GLStateCache::get().bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-    glNamedFramebufferTextureLayer(m_blitFbo, GL_COLOR_ATTACHMENT0, m_colorTexArray, 0, 3);
-    glBlitFramebuffer(0, 0, m_perViewWidth, m_perViewHeight, m_perViewWidth, m_perViewHeight, 2 * m_perViewWidth,
-                      2 * m_perViewHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  // all multisampled views get resolved by one dispatch, timed on its own
+  if(m_texturesAreMultisample)
+  {
+    uint32_t timer = m_gpuTimers.begin("Resolve views");
+    m_compositor.resolve(m_colorTexArray, m_resolveTexArray, numViews, m_targetWidth, m_targetHeight);
+    m_gpuTimers.end(timer);
+    // only the resolved copy is read from here on
+    glInvalidateTexImage(m_colorTexArray, 0);
   }
+
+  // one fullscreen pass lays out the 2 or 4 views and scales them to the window
+  ViewCompositor::Parameters parameters;
+  parameters.colorTexArray = m_texturesAreMultisample ? m_resolveTexArray : m_colorTexArray;
+  parameters.numViews      = numViews;
+  parameters.viewWidth     = m_perViewWidth;
+  parameters.viewHeight    = m_perViewHeight;
+  parameters.targetWidth   = getWindowWidth();
+  parameters.targetHeight  = getWindowHeight();
+  parameters.multiResLayout = m_settings.m_multiRes ? &m_multiResLayout : nullptr;
+
+  uint32_t timer = m_gpuTimers.begin("Compose views");
+  m_compositor.compose(fbo, parameters);
+  m_gpuTimers.end(timer);
+}
+
+void MVRDemo::reloadShaders()
+{
+  m_compositor.reloadShaders();
+  m_shadingAtlas.reloadShaders();
+  m_noiseVolume.reloadShaders();
 }
 
 void MVRDemo::processUI(double time)
@@ -261,14 +608,35 @@ void MVRDemo::processUI(double time)
   {
     ImGui::TextUnformatted("Input manually with CTRL+Click");
 
-    ImGui::SliderInt("Tori", &m_numberOfTori, 1, 1000, "%d", ImGuiSliderFlags_None);
+    if(m_settings.m_drawPath == MVRSettings::DrawPath::PER_OBJECT_DRAW)
+    {
+      ImGui::SliderInt("Tori", &m_numberOfTori, 1, MAX_TORI_PER_OBJECT_DRAW, "%d", ImGuiSliderFlags_Logarithmic);
+    }
+    else
+    {
+      // with a single draw call per pass the vertex throughput gets the limit, not the CPU
+      ImGui::SliderInt("Tori", &m_numberOfTori, 1, MAX_TORI, "%d", ImGuiSliderFlags_Logarithmic);
+    }
     ImGuiH::tooltip("Number of tori. Increase this number to make the CPU do more work.", false, 0.f);
 
     ImGui::SliderInt("Fragment load", &m_fragmentLoad, 1, 100, "%d", ImGuiSliderFlags_None);
     ImGuiH::tooltip(
         "Increase this number to make the fragment shader do more work. "
-        "Specifically, this is the number of times the fragment shader computes 3D simplex noise.",
+        "Specifically, this is the number of times the fragment shader computes 3D simplex noise, "
+        "with baked noise the number of octaves sampled from the noise volume (the volume resolves the first 3, "
+        "further ones only add the cost of their texture fetch).",
         false, 0.f);
+    ImGui::Checkbox("Baked noise", &m_settings.m_bakedNoise);
+    ImGuiH::tooltip(
+        "Sample the 3D noise from a repeating volume baked at startup by a compute shader instead of evaluating "
+        "simplex noise per fragment and per tessellated vertex. Each octave of the fragment load is one trilinear "
+        "texture fetch. Compare the GPU times to see the savings.",
+        false, 0.f);
+    if(m_settings.m_bakedNoise)
+    {
+      ImGui::Text("Noise volume: %d^3 texels, %.1f MB, baked in %.2f ms", int(NOISE_VOLUME_SIZE),
+                  double(m_noiseVolume.getBytes()) / (1024.0 * 1024.0), m_noiseVolume.getBakeMilliseconds());
+    }
 
     ImGui::SliderInt("Torus tessellation N", &torusTessellationN, 3, 64, "%d", ImGuiSliderFlags_None);
     ImGuiH::tooltip("Number of subdivisions around the axis of revolution.", false, 0.f);
@@ -276,6 +644,60 @@ void MVRDemo::processUI(double time)
     ImGuiH::tooltip("Number of subdivisions of the ring.", false, 0.f);
     ImGui::Text("Triangle count per torus: %d", (int)m_torus.getTriangleCount());
 
+    int vertexFormat = int(m_torus.getVertexFormat());
+    ImGui::Combo("Vertex format", &vertexFormat, "Float position + normal streams\0Compact interleaved\0");
+    ImGuiH::tooltip(
+        "Either two float3 streams (24 bytes per vertex) or one interleaved stream with 16 bit positions "
+        "relative to the torus bounds and octahedral encoded 16 bit normals (12 bytes per vertex).",
+        false, 0.f);
+    m_torus.setVertexFormat(Torus::VertexFormat(vertexFormat));
+    ImGui::Text("Vertices per torus: %d, %d bytes each", (int)m_torus.getVertexCount(), (int)m_torus.getVertexSize());
+
+    bool optimizeIndices = m_torus.getOptimizeIndices();
+    ImGui::Checkbox("Optimize index order", &optimizeIndices);
+    ImGuiH::tooltip(
+        "Reorder the triangles for post-transform vertex cache reuse (Forsyth). ACMR is the number of vertex "
+        "shader invocations per triangle, ATVR per vertex, both for a simulated 32 entry FIFO cache.",
+        false, 0.f);
+    m_torus.setOptimizeIndices(optimizeIndices);
+    const VertexCacheStatistics& vertexCache = m_torus.getVertexCacheStatistics();
+    ImGui::Text("ACMR %.3f, ATVR %.3f, %d bit indices", vertexCache.acmr, vertexCache.atvr,
+                m_torus.getIndexType() == GL_UNSIGNED_SHORT ? 16 : 32);
+
+    int cullingMode = int(m_cullingMode);
+    ImGui::Combo("Frustum culling", &cullingMode, "Off\0CPU\0GPU\0");
+    ImGuiH::tooltip(
+        "Test the bounding sphere of each torus against the frusta of all views and skip the tori visible in "
+        "none of them. The software fallback draws only the tori visible in the current view. The CPU culls with "
+        "SIMD (see the transform kernel), the GPU with a compute shader that also picks the levels of detail and "
+        "writes the multi draw indirect commands (other draw paths cull on the CPU). The instanced grid is never culled.",
+        false, 0.f);
+    m_cullingMode = CullingMode(cullingMode);
+    if(usesGpuCulling(m_settings.m_drawPath))
+    {
+      ImGui::Text("Visible tori: determined on the GPU (%s)", m_gpuCuller.usesDrawCount() ? "compacted" : "full length");
+    }
+    else
+    {
+      ImGui::Text("Visible tori: %u of %d", m_visibleTori, m_numberOfTori);
+    }
+
+    int lodCount = int(m_torus.getLodCount());
+    ImGui::SliderInt("Levels of detail", &lodCount, 1, 5);
+    ImGuiH::tooltip(
+        "Number of torus tessellations, each halving N and M of the previous one. Each torus uses the coarsest "
+        "level whose ring edges are at most the given length in pixels in every view, the instanced grid always "
+        "uses the finest level.",
+        false, 0.f);
+    m_torus.setLodCount(uint32_t(lodCount));
+    ImGui::SliderFloat("LOD edge length", &m_lodPixelsPerEdge, 1.0f, 64.0f, "%.1f px");
+    for(uint32_t lod = 0; lod < m_torus.getLodCount() && lod < m_lodDrawCounts.size(); ++lod)
+    {
+      ImGui::Text("LOD %u: %ux%u, %u tori", lod, m_torus.getLodTessellationN(lod), m_torus.getLodTessellationM(lod),
+                  m_lodDrawCounts[lod]);
+    }
+    ImGui::Text("Triangles per pass: %llu", (unsigned long long)m_lodTriangles);
+
     ImGui::Separator();
     if(m_settings.m_views == MVRSettings::Views::TWO_VIEWS)
     {
@@ -315,9 +737,66 @@ void MVRDemo::processUI(double time)
     if(ImGui::Button("Multi-View Rendering"))
       m_settings.m_renderMode = MVRSettings::RenderMode::MULTI_VIEW_RENDERING;
 
+    int drawPath = int(m_settings.m_drawPath);
+    ImGui::Combo("Draw path", &drawPath, "glDrawElements per torus\0glMultiDrawElementsIndirect\0Instanced grid\0");
+    ImGuiH::tooltip(
+        "Either one draw call per torus (and view in the software fallback), all tori in a single "
+        "multi draw indirect call per pass with the per torus data read from an SSBO, or a single instanced "
+        "draw call per pass where the vertex shader derives each torus' transform and color from gl_InstanceID.",
+        false, 0.f);
+    m_settings.m_drawPath = MVRSettings::DrawPath(drawPath);
+
     ImGui::Separator();
     ImGui::Checkbox("Multisample", &m_settings.m_multisample);
-    ImGuiH::tooltip("Use 4x multisample anti-aliasing.", false, 0.f);
+    ImGuiH::tooltip("Use multisample anti-aliasing, the views get resolved by one compute dispatch before the composition.",
+                    false, 0.f);
+    if(m_settings.m_multisample)
+    {
+      int sampleIndex = m_settings.m_samples >= 8 ? 2 : (m_settings.m_samples >= 4 ? 1 : 0);
+      ImGui::Combo("Samples", &sampleIndex, "2x\0" "4x\0" "8x\0");
+      ImGuiH::tooltip("Samples per pixel, limited by GL_MAX_SAMPLES and GL_MAX_COLOR/DEPTH_TEXTURE_SAMPLES.", false, 0.f);
+      m_settings.m_samples = 2u << sampleIndex;
+    }
+    ImGui::Checkbox("Multi-resolution", &m_settings.m_multiRes);
+    ImGuiH::tooltip(
+        "Split each view into 3 x 3 viewports with full resolution in the center and a lower resolution towards "
+        "the borders. With GL_NV_viewport_array2 the geometry is broadcast to all viewports in one pass, otherwise "
+        "it is drawn once per viewport. The composition un-warps the views.",
+        false, 0.f);
+    if(m_settings.m_multiRes)
+    {
+      ImGui::SliderFloat("Full resolution center", &m_settings.m_multiResCenter, 0.1f, 0.9f, "%.2f");
+      ImGui::SliderFloat("Border resolution", &m_settings.m_multiResDensity, 0.1f, 1.0f, "%.2f");
+    }
+    const double shadedPixels = double(m_targetWidth) * double(m_targetHeight);
+    ImGui::Text("Shaded pixels per view: %d x %d, %.0f%%", int(m_targetWidth), int(m_targetHeight),
+                100.0 * shadedPixels / std::max(1.0, double(m_perViewWidth) * double(m_perViewHeight)));
+    ImGui::Checkbox("Texture-space shading", &m_settings.m_shadingAtlas);
+    ImGuiH::tooltip(
+        "Shade the noise and the diffuse light of each torus once per frame into a tile of an atlas, addressed by "
+        "the torus angles, instead of once per view. The views only sample the atlas and add the specular term, "
+        "so the fragment load no longer scales with the number of views. Tori outside of all views are skipped.",
+        false, 0.f);
+    if(m_settings.m_shadingAtlas)
+    {
+      int tileIndex = 0;
+      while(tileIndex < 3 && (64u << tileIndex) < m_settings.m_atlasTileWidth)
+      {
+        ++tileIndex;
+      }
+      ImGui::Combo("Texels per torus", &tileIndex, "64 x 16\0" "128 x 32\0" "256 x 64\0" "512 x 128\0");
+      ImGuiH::tooltip("Tile size in the atlas, halved until the tiles of all tori fit into 4096 x 4096 texels.", false, 0.f);
+      m_settings.m_atlasTileWidth = 64u << tileIndex;
+
+      const glm::ivec4 atlas = m_shadingAtlas.getLayout();
+      ImGui::Text("Atlas: %d x %d tiles of %d x %d, %.1f Mtexels", atlas.x, atlas.w, atlas.y, atlas.z,
+                  double(m_shadingAtlas.getTexels()) / 1.0e6);
+    }
+    const RenderTargetPool::Statistics& renderTargets = m_renderTargets.getStatistics();
+    ImGui::Text("Render targets: %u textures, %.1f MB, %u allocations", renderTargets.textures,
+                double(renderTargets.bytes) / (1024.0 * 1024.0), renderTargets.allocations);
+    ImGuiH::tooltip("Texture arrays of the render target pool. Resizing the window reuses them as long as the views fit.",
+                    false, 0.f);
     ImGui::Checkbox("Use Geometry Shaders", &m_settings.m_useGeometryShader);
     ImGuiH::tooltip(
         "Render an arrow for the geometric normal of each triangle "
@@ -341,8 +820,40 @@ void MVRDemo::processUI(double time)
     ImGui::Text("GL_EXT_multiview_tessellation_geometry_shader: %s",
                 (m_pipeline->supportMVR_tessellation_geometry_shader ? "yes" : "no"));
     ImGui::Text("GL_EXT_multiview_timer_query: %s", (m_pipeline->supportMVR_timer_query ? "yes" : "no"));
+    ImGui::Text("GL_ARB_shader_draw_parameters: %s", (m_pipeline->supportDrawParameters ? "yes" : "no"));
+    ImGui::Text("GL_ARB_indirect_parameters: %s", (m_pipeline->supportIndirectParameters ? "yes" : "no"));
+    ImGui::Text("GL_KHR_parallel_shader_compile: %s", (m_pipeline->supportParallelShaderCompile ? "yes" : "no"));
+    ImGui::Text("GL_ARB_pipeline_statistics_query: %s", (m_pipeline->supportPipelineStatistics ? "yes" : "no"));
+    ImGui::Text("GL_NV_viewport_array2: %s", (m_pipeline->supportViewportArray2 ? "yes" : "no"));
+
+    const ProgramCache::Statistics& programs = m_pipeline->getProgramStatistics();
+    const ProgramCache::Progress    progress = m_pipeline->getProgramProgress();
+    ImGui::Text("Programs: %u of %u linked, %u compiling", progress.linked, progress.total, progress.pending);
+    ImGui::Text("%u cached, %u compiled, %u rejected, %.1f ms blocking", programs.loaded, programs.compiled,
+                programs.rejected, programs.milliseconds);
 
     ImGui::Separator();
+
+    const PipelineStatistics::Values& statistics = m_pipelineStatistics.getValues();
+    if(statistics.valid && ImGui::CollapsingHeader("Pipeline statistics"))
+    {
+      // per view, so rendering the views one by one compares directly to sharing the work between them
+      const double views = m_settings.m_views == MVRSettings::Views::QUAD_VIEW ? 4.0 : 2.0;
+      const double tori  = double(std::max(getDrawnTori(), 1u));
+      ImGui::Text("%-16s %12s %12s", "per view", "frame", "torus");
+      for(int i = 0; i < PipelineStatistics::NUM_COUNTERS; ++i)
+      {
+        const double perView = double(statistics.counters[i]) / views;
+        ImGui::Text("%-16s %12.0f %12.1f", PipelineStatistics::getCounterName(PipelineStatistics::Counter(i)), perView,
+                    perView / tori);
+      }
+      ImGuiH::tooltip(
+          "Shader invocations and primitives of the scene pass divided by the number of views, "
+          "the torus column also per drawn torus (the visible ones, all of them with GPU culling). "
+          "Single Pass Stereo and Multi-View Rendering share the vertex work of the views, "
+          "the software fallback repeats it per view.",
+          false, 0.f);
+    }
   }
   ImGui::End();
 
@@ -352,6 +863,11 @@ void MVRDemo::processUI(double time)
   }
 }
 
+uint32_t MVRDemo::getDrawnTori() const
+{
+  return usesGpuCulling(m_settings.m_drawPath) ? uint32_t(m_numberOfTori) : m_visibleTori;
+}
+
 void MVRDemo::updatePerFrameUniforms(uint32_t width, uint32_t height)
 {
   auto view  = m_control.m_viewMatrix;
@@ -368,7 +884,6 @@ void MVRDemo::updatePerFrameUniforms(uint32_t width, uint32_t height)
 
   m_pipeline->setProjectionMatrix(proj);
   m_pipeline->setViewMatrix(view);
-  m_pipeline->sceneData.torusScale         = m_torus_scale;
   m_pipeline->sceneData.fragmentLoadFactor = m_fragmentLoad;
 
   if(m_settings.m_views == MVRSettings::Views::TWO_VIEWS)
@@ -407,8 +922,7 @@ void MVRDemo::updatePerFrameUniforms(uint32_t width, uint32_t height)
     }
   }
 
-  // upload to GPU:
-  m_pipeline->updateSceneUniforms();
+  // uploaded by renderFrame() once the per frame scene data is complete
 }
 
 void MVRDemo::validateSettings()
@@ -432,6 +946,44 @@ void MVRDemo::validateSettings()
     m_settings.m_renderMode = MVRSettings::RenderMode::SOFTWARE_FALLBACK;
   }
 
+  // Multi-View Rendering into multisample texture arrays needs GL_EXT_multiview_texture_multisample
+  if(m_settings.m_multisample && m_settings.m_renderMode == MVRSettings::RenderMode::MULTI_VIEW_RENDERING
+     && mvrPipeline->supportMVR_texture_multisample == false)
+  {
+    m_settings.m_multisample = false;
+  }
+  if(m_settings.m_multisample)
+  {
+    // the largest supported power of two
+    while(m_settings.m_samples > 2 && m_settings.m_samples > m_maxSamples)
+    {
+      m_settings.m_samples /= 2;
+    }
+    if(m_settings.m_samples > m_maxSamples)
+    {
+      m_settings.m_multisample = false;
+    }
+  }
+
+  if(m_settings.m_shadingAtlas && !m_shadingAtlasValid)
+  {
+    m_settings.m_shadingAtlas = false;
+  }
+
+  if(m_settings.m_bakedNoise && !m_noiseVolumeValid)
+  {
+    m_settings.m_bakedNoise = false;
+  }
+
+  if(m_settings.m_drawPath == MVRSettings::DrawPath::MULTI_DRAW_INDIRECT && mvrPipeline->supportDrawParameters == false)
+  {
+    m_settings.m_drawPath = MVRSettings::DrawPath::PER_OBJECT_DRAW;
+  }
+
+  // also catches CTRL+Click input and switching back to per object draws with many tori
+  const int maxTori = m_settings.m_drawPath == MVRSettings::DrawPath::PER_OBJECT_DRAW ? MAX_TORI_PER_OBJECT_DRAW : MAX_TORI;
+  m_numberOfTori    = std::min(std::max(m_numberOfTori, 1), maxTori);
+
   if(m_settings.m_renderMode == MVRSettings::RenderMode::MULTI_VIEW_RENDERING
      && (m_settings.m_useGeometryShader || m_settings.m_useTessellationShader)
      && mvrPipeline->supportMVR_tessellation_geometry_shader == false)
@@ -23,8 +23,15 @@
 
 #include <glm/glm.hpp>
 #include "common.h"
+#include "MVRBenchmark.h"
 #include "MVRPipeline.h"
+#include "PipelineStatistics.h"
+#include "RenderTargetPool.h"
 #include "MVRSettings.h"
+#include "MultiResLayout.h"
+#include "NoiseVolume.h"
+#include "ShadingAtlas.h"
+#include "ViewCompositor.h"
 
 #include <cstdint>
 #include <memory>
@@ -44,28 +51,78 @@ public:
   // called for each frame
   void renderFrame(double time, uint32_t width, uint32_t height, GLuint fbo) override;
 
+  // registers the command line parameters
+  void setupConfigParameters() override;
+
 private:
   void processUI(double time) override;
+  void onFrameBegin() override;
+  void onFrameEnd() override;
   void updatePerFrameUniforms(uint32_t width, uint32_t height);
+  // tori drawn by the scene pass: the visible ones, all of them if the GPU culls (the count stays on the GPU)
+  uint32_t getDrawnTori() const;
 
   void renderToTexture();
-  void blitToFramebuffer(GLuint fbo);
+  // renderTori() into the bound view framebuffer, once per multi-resolution cell without GL_NV_viewport_array2
+  void renderScene(GLenum primitiveMode, uint32_t viewMask = ~0u);
+  void composeViews(GLuint fbo);
+  void reloadShaders() override;
+  void reportMemory(MemoryReport& report) const override;
 
   // called at init and when the sample resizes
   void initTextures(uint32_t width, uint32_t height, bool forceReInit = false);
+  // called when initTextures() got different textures from the pool
+  void initFramebuffers();
+  void deinitFramebuffers();
 
-  // Framebuffer and textures to render into before the result
-  // is blit into the sample frameworks FBO
-  GLuint  m_fbo                    = 0;
-  GLuint  m_blitFbo                = 0;
-  GLuint  m_colorTexArray          = 0;
-  GLuint  m_depthTexArray          = 0;
-  GLsizei m_perViewHeight          = 0;
-  GLsizei m_perViewWidth           = 0;
-  bool    m_texturesAreMultisample = false;
+  // Framebuffers and textures to render into before the result is composed into the window
+  // by m_compositor, the textures may be larger than the views (see RenderTargetPool)
+  RenderTargetPool m_renderTargets;
+  struct
+  {
+    GLuint layers[MAX_VIEWS] = {};  // software fallback, one layer each
+    GLuint layered           = 0;   // Single Pass Stereo, all layers
+    GLuint multiview         = 0;   // Multi-View Rendering, all layers
+  } m_viewFramebuffers;
+  GLuint         m_colorTexArray          = 0;
+  GLuint         m_depthTexArray          = 0;
+  GLuint         m_resolveTexArray        = 0;  // single sampled copy of the multisampled color views
+  GLsizei        m_perViewHeight          = 0;
+  GLsizei        m_perViewWidth           = 0;
+  GLsizei        m_targetHeight           = 0;  // rendered pixels of each view, less than the above with multi-resolution
+  GLsizei        m_targetWidth            = 0;
+  MultiResLayout m_multiResLayout;  // of the current views if m_settings.m_multiRes
+  bool           m_texturesAreMultisample = false;
+  GLsizei        m_textureSamples         = 0;
+  GLsizei        m_textureLayers          = 0;  // one per view
+  uint32_t       m_maxSamples             = 0;  // of multisample color and depth textures
+  ViewCompositor m_compositor;
+  ShadingAtlas   m_shadingAtlas;  // shaded once per frame before the views if m_settings.m_shadingAtlas
+  bool           m_shadingAtlasValid = false;
+  NoiseVolume    m_noiseVolume;  // baked at startup, sampled by the scene if m_settings.m_bakedNoise
+  bool           m_noiseVolumeValid = false;
 
   struct MVRSettings m_settings;
 
-  // checks the settings and resolves unsupported combinations
+  // checks the settings and resolves unsupported combinations, also clamps m_numberOfTori to the draw path
   void validateSettings();
+  // per frame limits of m_numberOfTori, one draw call per torus and view with PER_OBJECT_DRAW
+  static const int MAX_TORI_PER_OBJECT_DRAW = 10000;
+  static const int MAX_TORI                 = 500000;
+
+  // optional benchmark sweep, see MVRBenchmark.h
+  MVRBenchmark m_benchmark;
+  bool         m_benchmarkFrameActive = false;
+
+  // tori count of the transform kernel microbenchmark run at startup, see BatchTransform::runMicrobenchmark()
+  int m_transformBenchmarkObjects = 0;
+
+  // linked programs are stored next to the executable, see ProgramCache
+  bool m_useProgramCache = true;
+
+  // applied to CpuTrace in begin(), toggled in the UI afterwards
+  bool m_cpuTrace = false;
+
+  // shader stage work of the scene pass
+  PipelineStatistics m_pipelineStatistics;
 };
@@ -22,8 +22,8 @@
 
 #include "nvh/nvprint.hpp"
 
-MVRPipeline::MVRPipeline()
-    : Pipeline<vertexload::SceneDataMVR, vertexload::ObjectData>(UBO_SCENE, UBO_OBJECT)
+MVRPipeline::MVRPipeline(const std::string& programCacheDirectory)
+    : Pipeline<vertexload::SceneDataMVR, vertexload::ObjectData>(UBO_SCENE, UBO_OBJECT, SSBO_OBJECT)
 {
   // check hardware support
   // the next extension is not known to GLEW, so test for it manually:
@@ -53,6 +53,26 @@ MVRPipeline::MVRPipeline()
     {
       supportMVR_timer_query = true;
     }
+    if(name == "GL_ARB_shader_draw_parameters")
+    {
+      supportDrawParameters = true;
+    }
+    if(name == "GL_ARB_indirect_parameters")
+    {
+      supportIndirectParameters = true;
+    }
+    if(name == "GL_KHR_parallel_shader_compile" || name == "GL_ARB_parallel_shader_compile")
+    {
+      supportParallelShaderCompile = true;
+    }
+    if(name == "GL_ARB_pipeline_statistics_query")
+    {
+      supportPipelineStatistics = true;
+    }
+    if(name == "GL_NV_viewport_array2")
+    {
+      supportViewportArray2 = true;
+    }
   }
 
   LOGOK("\nGL_NV_stereo_view_rendering extension %sfound!\n", supportSPS ? "" : "NOT ");
@@ -60,57 +80,113 @@ MVRPipeline::MVRPipeline()
   LOGOK("\nGL_EXT_multiview_texture_multisample extension %sfound!\n", supportMVR_texture_multisample ? "" : "NOT ");
   LOGOK("\nGL_EXT_multiview_tessellation_geometry_shader extension %sfound!\n", supportMVR_tessellation_geometry_shader ? "" : "NOT ");
   LOGOK("\nGL_EXT_multiview_timer_query extension %sfound!\n", supportMVR_timer_query ? "" : "NOT ");
+  LOGOK("\nGL_ARB_shader_draw_parameters extension %sfound!\n", supportDrawParameters ? "" : "NOT ");
+  LOGOK("\nGL_ARB_indirect_parameters extension %sfound!\n", supportIndirectParameters ? "" : "NOT ");
+  LOGOK("\nGL_KHR_parallel_shader_compile extension %sfound!\n", supportParallelShaderCompile ? "" : "NOT ");
+  LOGOK("\nGL_ARB_pipeline_statistics_query extension %sfound!\n", supportPipelineStatistics ? "" : "NOT ");
+  LOGOK("\nGL_NV_viewport_array2 extension %sfound!\n", supportViewportArray2 ? "" : "NOT ");
 
 
-  // init shaders
-  m_progManager.registerInclude("common.h", "common.h");
+  // init shaders, only the programs a frame asks for get built right away, see setSettings()
+  m_programCache.setCacheDirectory(programCacheDirectory);
+  m_programCache.setParallelCompile(supportParallelShaderCompile);
 
-  initShaders(m_programs.software, "");
-  initShaders(m_programs.sps, "#define STEREO_SPS\n");
-  if(supportMVR)
+  for(int drawPath = 0; drawPath < MVRSettings::NUM_DRAW_PATHS; ++drawPath)
   {
-    initShaders(m_programs.mvr, "#define STEREO_MVR\n#define MVR_VIEWS 2\n", !supportMVR_tessellation_geometry_shader);
-    initShaders(m_programs.mvr_quad, "#define STEREO_MVR\n#define MVR_VIEWS 4\n", !supportMVR_tessellation_geometry_shader);
+    std::string drawDefines;
+    if(drawPath == MVRSettings::DrawPath::MULTI_DRAW_INDIRECT)
+    {
+      // the object data is read from an SSBO indexed by gl_BaseInstanceARB
+      if(!supportDrawParameters)
+        continue;
+      drawDefines = "#define USE_OBJECT_SSBO\n";
+    }
+    else if(drawPath == MVRSettings::DrawPath::INSTANCED_GRID)
+    {
+      // the object data is derived from gl_InstanceID and the grid in the scene data
+      drawDefines = "#define USE_INSTANCED_GRID\n";
+    }
+
+    // without GL_NV_viewport_array2 MVRDemo renders the multi-resolution cells one by one with the regular programs
+    for(int variant = 0; variant < NUM_VARIANTS; ++variant)
+    {
+      const bool multiRes = (variant & VARIANT_MULTIRES) != 0;
+      if(multiRes && !supportViewportArray2)
+        continue;
+
+      std::string defines = drawDefines;
+      if(variant & VARIANT_SHADING_ATLAS)
+      {
+        // the fragment shader samples the view independent shading from the ShadingAtlas
+        defines += "#define SHADE_ATLAS\n";
+      }
+      if(variant & VARIANT_BAKED_NOISE)
+      {
+        // the fragment and tessellation evaluation shaders sample the NoiseVolume
+        defines += "#define BAKED_NOISE\n";
+      }
+
+      Programs& programs = m_programs[variant][drawPath];
+      initShaders(programs.software, defines, false, multiRes);
+      if(supportSPS)
+      {
+        initShaders(programs.sps, defines + "#define STEREO_SPS\n", false, multiRes);
+      }
+      if(supportMVR)
+      {
+        initShaders(programs.mvr, defines + "#define STEREO_MVR\n#define MVR_VIEWS 2\n",
+                    !supportMVR_tessellation_geometry_shader, multiRes);
+        initShaders(programs.mvr_quad, defines + "#define STEREO_MVR\n#define MVR_VIEWS 4\n",
+                    !supportMVR_tessellation_geometry_shader, multiRes);
+      }
+    }
   }
 
-  bool valid = m_progManager.areProgramsValid();
+  m_program = m_programs[0][MVRSettings::DrawPath::PER_OBJECT_DRAW].software.VS;
+  bool valid = m_programCache.buildProgram(m_program, true);
   if(!valid)
   {
     LOGE("Error loading shader files\n");
   }
 
-  m_program = m_programs.software.VS;
+  // cold start: compiled, warm start: loaded from the cache
+  const ProgramCache::Statistics& statistics = getProgramStatistics();
+  LOGI("Built %u of %u programs in %.1f ms: %u from the binary cache, %u compiled, %u stale binaries rejected\n",
+       statistics.loaded + statistics.compiled, m_programCache.getProgress().total, statistics.milliseconds,
+       statistics.loaded, statistics.compiled, statistics.rejected);
 }
 
-void MVRPipeline::initShaders(PipelineVariants& progs, const std::string& defines, bool excludeTSandGS)
+void MVRPipeline::initShaders(PipelineVariants& progs, const std::string& defines, bool excludeTSandGS, bool multiRes)
 {
   std::string generalDefines = "#define USE_MVR_SCENE_DATA\n";
 
   std::string allDefines = generalDefines + defines;
-  progs.VS =
-      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, allDefines, "mvr_scene.vert.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, allDefines, "mvr_scene.frag.glsl"));
+
+  // with multiRes the last stage before the rasterizer writes the viewport mask
+  const std::string vsDefines  = multiRes ? allDefines + "#define MULTIRES_VS\n" : allDefines;
+  const std::string tesDefines = multiRes ? allDefines + "#define MULTIRES_TES\n" : allDefines;
+  const std::string gsDefines  = multiRes ? allDefines + "#define MULTIRES_GS\n" : allDefines;
+
+  progs.VS = m_programCache.addProgram(vsDefines, {{GL_VERTEX_SHADER, "mvr_scene.vert.glsl"},  //
+                                                   {GL_FRAGMENT_SHADER, "mvr_scene.frag.glsl"}});
 
   if(excludeTSandGS)
     return;
 
-  progs.VS_GS =
-      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, allDefines, "mvr_scene.vert.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_GEOMETRY_SHADER, allDefines, "mvr_scene.geo.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, allDefines, "mvr_scene.frag.glsl"));
-
-  progs.VS_TS =
-      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, allDefines, "mvr_scene.vert.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_TESS_CONTROL_SHADER, allDefines, "mvr_scene.tcs.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_TESS_EVALUATION_SHADER, allDefines, "mvr_scene.tes.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, allDefines, "mvr_scene.frag.glsl"));
-
-  progs.VS_TS_GS =
-      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, allDefines, "mvr_scene.vert.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_TESS_CONTROL_SHADER, allDefines, "mvr_scene.tcs.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_TESS_EVALUATION_SHADER, allDefines, "mvr_scene.tes.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_GEOMETRY_SHADER, allDefines, "mvr_scene.geo.glsl"),
-                                  nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, allDefines, "mvr_scene.frag.glsl"));
+  progs.VS_GS = m_programCache.addProgram(gsDefines, {{GL_VERTEX_SHADER, "mvr_scene.vert.glsl"},    //
+                                                      {GL_GEOMETRY_SHADER, "mvr_scene.geo.glsl"},   //
+                                                      {GL_FRAGMENT_SHADER, "mvr_scene.frag.glsl"}});
+
+  progs.VS_TS = m_programCache.addProgram(tesDefines, {{GL_VERTEX_SHADER, "mvr_scene.vert.glsl"},           //
+                                                       {GL_TESS_CONTROL_SHADER, "mvr_scene.tcs.glsl"},      //
+                                                       {GL_TESS_EVALUATION_SHADER, "mvr_scene.tes.glsl"},   //
+                                                       {GL_FRAGMENT_SHADER, "mvr_scene.frag.glsl"}});
+
+  progs.VS_TS_GS = m_programCache.addProgram(gsDefines, {{GL_VERTEX_SHADER, "mvr_scene.vert.glsl"},           //
+                                                         {GL_TESS_CONTROL_SHADER, "mvr_scene.tcs.glsl"},      //
+                                                         {GL_TESS_EVALUATION_SHADER, "mvr_scene.tes.glsl"},   //
+                                                         {GL_GEOMETRY_SHADER, "mvr_scene.geo.glsl"},          //
+                                                         {GL_FRAGMENT_SHADER, "mvr_scene.frag.glsl"}});
 }
 
 MVRPipeline::~MVRPipeline() {}
@@ -119,24 +195,37 @@ void MVRPipeline::setSettings(struct MVRSettings settings)
 {
   m_settings = settings;
 
-  PipelineVariants* progs;
-  if(m_settings.m_renderMode == MVRSettings::RenderMode::SOFTWARE_FALLBACK)
+  // multi draw indirect reads all objects from one SSBO
+  setObjectArrayLayout(m_settings.m_drawPath == MVRSettings::DrawPath::MULTI_DRAW_INDIRECT);
+
+  int variant = 0;
+  if(m_settings.m_multiRes && supportViewportArray2)
+  {
+    variant |= VARIANT_MULTIRES;
+  }
+  if(m_settings.m_shadingAtlas)
+  {
+    variant |= VARIANT_SHADING_ATLAS;
+  }
+  if(m_settings.m_bakedNoise)
   {
-    progs = &m_programs.software;
+    variant |= VARIANT_BAKED_NOISE;
   }
-  else if(m_settings.m_renderMode == MVRSettings::RenderMode::SINGLE_PASS_STEREO)
+  Programs&         programs = m_programs[variant][m_settings.m_drawPath];
+  PipelineVariants* progs    = &programs.software;
+  if(m_settings.m_renderMode == MVRSettings::RenderMode::SINGLE_PASS_STEREO)
   {
-    progs = &m_programs.sps;
+    progs = &programs.sps;
   }
   else if(m_settings.m_renderMode == MVRSettings::RenderMode::MULTI_VIEW_RENDERING)
   {
     if(m_settings.m_views == MVRSettings::Views::TWO_VIEWS)
     {
-      progs = &m_programs.mvr;
+      progs = &programs.mvr;
     }
     else
     {
-      progs = &m_programs.mvr_quad;
+      progs = &programs.mvr_quad;
     }
   }
 
@@ -157,11 +246,27 @@ void MVRPipeline::setSettings(struct MVRSettings settings)
   {
     m_program = progs->VS;
   }
+  m_usesTessellation = m_settings.m_useTessellationShader;
+
+  // the first request builds the program, with parallel compilation the frame doesn't wait for the geometry and
+  // tessellation shader variants but renders with the plain vertex shader variant of the same mode until they are linked
+  if(!m_programCache.buildProgram(m_program, m_waitForPrograms) && m_programCache.isPending(m_program))
+  {
+    if(m_program != progs->VS && m_programCache.buildProgram(progs->VS, true))
+    {
+      m_program          = progs->VS;
+      m_usesTessellation = false;
+    }
+    else
+    {
+      m_programCache.buildProgram(m_program, true);
+    }
+  }
 }
 
-void MVRPipeline::updateObjectUniforms()
+void MVRPipeline::updateObjectData()
 {
   objectData.color = m_objectColor;
 
-  Pipeline<vertexload::SceneDataMVR, vertexload::ObjectData>::updateObjectUniforms();
+  Pipeline<vertexload::SceneDataMVR, vertexload::ObjectData>::updateObjectData();
 }
@@ -32,21 +32,34 @@
 class MVRPipeline : public Pipeline<vertexload::SceneDataMVR, vertexload::ObjectData>
 {
 public:
-  MVRPipeline();
+  /// @brief Builds all programs, the linked binaries are cached in programCacheDirectory (empty: always compile).
+  MVRPipeline(const std::string& programCacheDirectory);
   ~MVRPipeline();
 
   void setObjectColor(const glm::vec3& color) { m_objectColor = color; }
 
   void setSettings(struct MVRSettings settings);
 
-  void updateObjectUniforms() override;
-
   // set after the hardware support has been checked:
   bool supportSPS                              = false;
   bool supportMVR                              = false;
   bool supportMVR_texture_multisample          = false;
   bool supportMVR_timer_query                  = false;
   bool supportMVR_tessellation_geometry_shader = false;
+  bool supportDrawParameters                   = false;
+  bool supportIndirectParameters               = false;
+  bool supportParallelShaderCompile            = false;
+  bool supportPipelineStatistics               = false;
+  bool supportViewportArray2                   = false;
+
+  /// @brief False while the tessellation variant of the settings is still compiling and its fallback is used
+  ///        (draw GL_TRIANGLES instead of GL_PATCHES then).
+  bool usesTessellation() const { return m_usesTessellation; }
+  /// @brief Makes setSettings() wait for the requested program instead of using a fallback (e.g. for benchmarks).
+  void setWaitForPrograms(bool wait) { m_waitForPrograms = wait; }
+
+protected:
+  void updateObjectData() override;
 
 private:
   // All programs come from the same scene.*.glsl shader files but are compiled with
@@ -55,13 +68,14 @@ private:
   struct PipelineVariants
   {
     // simple shaders for all render modes:
-    nvgl::ProgramID VS;
-    nvgl::ProgramID VS_GS;
-    nvgl::ProgramID VS_TS;
-    nvgl::ProgramID VS_TS_GS;
+    ProgramCache::ProgramID VS       = ProgramCache::INVALID_PROGRAM;
+    ProgramCache::ProgramID VS_GS    = ProgramCache::INVALID_PROGRAM;
+    ProgramCache::ProgramID VS_TS    = ProgramCache::INVALID_PROGRAM;
+    ProgramCache::ProgramID VS_TS_GS = ProgramCache::INVALID_PROGRAM;
   };
 
-  void initShaders(PipelineVariants& progs, const std::string& defines, bool excludeTSandGS = false);
+  // multiRes: the last stage before the rasterizer broadcasts each primitive to the MULTIRES_VIEWPORTS viewports
+  void initShaders(PipelineVariants& progs, const std::string& defines, bool excludeTSandGS = false, bool multiRes = false);
 
   struct Programs
   {
@@ -71,9 +85,21 @@ private:
     PipelineVariants mvr_quad;
   };
 
-  Programs m_programs;
+  // program variants on top of the render mode and the draw path, combinations of these bits
+  enum VariantBits
+  {
+    VARIANT_MULTIRES      = 1,  // MVRSettings::m_multiRes, only with GL_NV_viewport_array2
+    VARIANT_SHADING_ATLAS = 2,  // MVRSettings::m_shadingAtlas
+    VARIANT_BAKED_NOISE   = 4,  // MVRSettings::m_bakedNoise
+    NUM_VARIANTS          = 8
+  };
+
+  // one set of programs per variant and MVRSettings::DrawPath
+  Programs m_programs[NUM_VARIANTS][MVRSettings::NUM_DRAW_PATHS];
 
   glm::vec3 m_objectColor;
 
   struct MVRSettings m_settings;
+  bool               m_usesTessellation = false;
+  bool               m_waitForPrograms  = false;
 };
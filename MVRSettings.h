@@ -23,9 +23,16 @@
 
 struct MVRSettings
 {
-  bool m_multisample           = false;
-  bool m_useGeometryShader     = false;
-  bool m_useTessellationShader = false;
+  bool     m_multisample           = false;
+  uint32_t m_samples               = 4;  // with m_multisample: 2, 4 or 8, clamped to what the GL supports
+  bool     m_multiRes              = false;
+  float    m_multiResCenter        = 0.6f;  // with m_multiRes: fraction of each view axis at full resolution
+  float    m_multiResDensity       = 0.5f;  // with m_multiRes: resolution of the view borders, see MultiResLayout
+  bool     m_shadingAtlas          = false;
+  uint32_t m_atlasTileWidth        = 256;  // with m_shadingAtlas: texels per torus around its axis, see ShadingAtlas
+  bool     m_bakedNoise            = false;  // sample the NoiseVolume instead of evaluating the noise
+  bool     m_useGeometryShader     = false;
+  bool     m_useTessellationShader = false;
   enum Views
   {
     TWO_VIEWS,
@@ -37,4 +44,22 @@ struct MVRSettings
     SINGLE_PASS_STEREO,
     MULTI_VIEW_RENDERING
   } m_renderMode = RenderMode::SOFTWARE_FALLBACK;
+  enum DrawPath
+  {
+    PER_OBJECT_DRAW,      // one glDrawElements per torus
+    MULTI_DRAW_INDIRECT,  // one glMultiDrawElementsIndirect per pass
+    INSTANCED_GRID,       // one glDrawElementsInstanced per pass, transforms generated in the vertex shader
+    NUM_DRAW_PATHS
+  } m_drawPath = DrawPath::PER_OBJECT_DRAW;
+
+  bool operator==(const MVRSettings& other) const
+  {
+    return m_multisample == other.m_multisample && m_samples == other.m_samples && m_multiRes == other.m_multiRes
+           && m_multiResCenter == other.m_multiResCenter && m_multiResDensity == other.m_multiResDensity
+           && m_shadingAtlas == other.m_shadingAtlas && m_atlasTileWidth == other.m_atlasTileWidth
+           && m_bakedNoise == other.m_bakedNoise && m_useGeometryShader == other.m_useGeometryShader
+           && m_useTessellationShader == other.m_useTessellationShader && m_views == other.m_views
+           && m_renderMode == other.m_renderMode && m_drawPath == other.m_drawPath;
+  }
+  bool operator!=(const MVRSettings& other) const { return !(*this == other); }
 };
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief The textures and buffers the demo owns with their sizes, collected by the reportMemory() methods
+///        for the memory panel and the benchmark results. Sizes are computed from the allocation parameters,
+///        drivers may add alignment and metadata.
+struct MemoryReport
+{
+  struct Entry
+  {
+    const char* owner;
+    std::string name;
+    uint64_t    bytes;
+  };
+  std::vector<Entry> entries;
+
+  void add(const char* owner, const std::string& name, uint64_t bytes)
+  {
+    if(bytes)
+    {
+      entries.push_back({owner, name, bytes});
+    }
+  }
+
+  uint64_t getTotal() const
+  {
+    uint64_t total = 0;
+    for(const Entry& entry : entries)
+    {
+      total += entry.bytes;
+    }
+    return total;
+  }
+};
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "MultiResLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+void MultiResLayout::update(GLsizei viewWidth, GLsizei viewHeight, float center_, float density)
+{
+  center  = std::min(std::max(center_, 0.1f), 0.9f);
+  density = std::min(std::max(density, 0.1f), 1.0f);
+
+  const glm::ivec2 viewPixels(viewWidth, viewHeight);
+  for(int axis = 0; axis < 2; ++axis)
+  {
+    // a view pixel covers 2 / viewPixels in NDC, the outer cells each cover (1 - center) of it
+    const float outer  = 0.5f * (1.0f - center) * float(viewPixels[axis]);
+    centerPixels[axis] = std::max(1, viewPixels[axis] - 2 * int(std::lround(outer)));
+    outerPixels[axis]  = int(std::lround(outer * density));
+  }
+  width  = 2 * outerPixels.x + centerPixels.x;
+  height = 2 * outerPixels.y + centerPixels.y;
+
+  // NDC and target pixel bounds of the cells along one axis
+  const float ndcBounds[4] = {-1.0f, -center, center, 1.0f};
+  for(int y = 0; y < 3; ++y)
+  {
+    for(int x = 0; x < 3; ++x)
+    {
+      const glm::ivec2 cell(x, y);
+      const int        index = x + 3 * y;
+      for(int axis = 0; axis < 2; ++axis)
+      {
+        const int pixelBounds[4] = {0, outerPixels[axis], outerPixels[axis] + centerPixels[axis],
+                                    2 * outerPixels[axis] + centerPixels[axis]};
+        const int   begin    = pixelBounds[cell[axis]];
+        const int   size     = pixelBounds[cell[axis] + 1] - begin;
+        const float ndcBegin = ndcBounds[cell[axis]];
+        const float ndcSize  = ndcBounds[cell[axis] + 1] - ndcBegin;
+
+        // the viewport maps NDC -1..1, scaled such that the cell's NDC range lands on its pixels
+        const float pixelsPerNdc   = float(size) / ndcSize;
+        viewports[index][axis]     = float(begin) - (ndcBegin + 1.0f) * pixelsPerNdc;
+        viewports[index][axis + 2] = 2.0f * pixelsPerNdc;
+        scissors[index][axis]      = begin;
+        scissors[index][axis + 2]  = size;
+      }
+    }
+  }
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <glm/glm.hpp>
+#include "common.h"
+
+/// @brief Splits a view into 3 x 3 cells with full pixel density in the center cell and a lower density in
+///        the outer ones. The view gets rendered once into a smaller target with one viewport and scissor
+///        rectangle per cell, all viewports share the projection of the view (each one maps the full clip
+///        space, the scissor keeps only its cell). ViewCompositor un-warps the target into the window.
+struct MultiResLayout
+{
+  /// @brief center: fraction of the view (per axis, in NDC) at full density, clamped to 0.1 .. 0.9,
+  ///        density: pixels per view pixel of the outer cells, 1 keeps the full resolution.
+  void update(GLsizei viewWidth, GLsizei viewHeight, float center, float density);
+
+  float center = 0.5f;
+
+  // per axis (x, y): pixels of one outer cell and of the center cell in the target
+  glm::ivec2 outerPixels  = glm::ivec2(0);
+  glm::ivec2 centerPixels = glm::ivec2(0);
+
+  // the warped target, outer + center + outer pixels
+  GLsizei width  = 0;
+  GLsizei height = 0;
+
+  // cell x + 3 * y, for glViewportArrayv and glScissorArrayv
+  GLfloat viewports[MULTIRES_VIEWPORTS][4] = {};
+  GLint   scissors[MULTIRES_VIEWPORTS][4]  = {};
+};
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "NoiseVolume.h"
+#include "GLStateCache.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <string>
+#include <vector>
+
+// Search paths for shaders, defined in main.cpp
+extern std::vector<std::string> defaultSearchPaths;
+
+bool NoiseVolume::init()
+{
+  for(const auto& path : defaultSearchPaths)
+  {
+    m_progManager.addDirectory(path);
+  }
+  m_progManager.registerInclude("common.h", "common.h");
+  m_progManager.registerInclude("noise.glsl", "noise.glsl");
+  m_program = m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "", "mvr_noise.comp.glsl"));
+  if(!m_progManager.areProgramsValid())
+  {
+    LOGE("Error loading the noise volume shader\n");
+    return false;
+  }
+
+  glCreateTextures(GL_TEXTURE_3D, 1, &m_texture);
+  glTextureStorage3D(m_texture, 1, GL_R16F, NOISE_VOLUME_SIZE, NOISE_VOLUME_SIZE, NOISE_VOLUME_SIZE);
+  glTextureParameteri(m_texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTextureParameteri(m_texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTextureParameteri(m_texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTextureParameteri(m_texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTextureParameteri(m_texture, GL_TEXTURE_WRAP_R, GL_REPEAT);
+
+  bake();
+  return true;
+}
+
+void NoiseVolume::deinit()
+{
+  m_progManager.deletePrograms();
+  glDeleteTextures(1, &m_texture);
+  m_texture = 0;
+}
+
+void NoiseVolume::reloadShaders()
+{
+  m_progManager.reloadPrograms();
+  if(m_texture && m_progManager.isValid(m_program))
+  {
+    bake();
+  }
+}
+
+void NoiseVolume::bake()
+{
+  GLuint query = 0;
+  glCreateQueries(GL_TIME_ELAPSED, 1, &query);
+  glBeginQuery(GL_TIME_ELAPSED, query);
+
+  GLStateCache::get().useProgram(m_progManager.get(m_program));
+  glBindImageTexture(IMG_NOISE_VOLUME, m_texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+  const GLuint groups = (NOISE_VOLUME_SIZE + NOISE_WORKGROUP_SIZE - 1) / NOISE_WORKGROUP_SIZE;
+  glDispatchCompute(groups, groups, groups);
+
+  glEndQuery(GL_TIME_ELAPSED);
+
+  // the scene shaders fetch the baked texels
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+  // only at startup and on shader reloads, waiting for the result is fine
+  GLuint64 nanoseconds = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+  glDeleteQueries(1, &query);
+  m_bakeMilliseconds = double(nanoseconds) / 1.0e6;
+
+  LOGI("noise volume: %u^3 texels, %.1f MB, baked in %.2f ms\n", uint32_t(NOISE_VOLUME_SIZE),
+       double(getBytes()) / (1024.0 * 1024.0), m_bakeMilliseconds);
+}
+
+void NoiseVolume::reportMemory(MemoryReport& report) const
+{
+  report.add("NoiseVolume", "noise", getBytes());
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+#include "nvgl/programmanager_gl.hpp"
+
+#include <glm/glm.hpp>
+#include "common.h"
+#include "MemoryReport.h"
+
+#include <cstdint>
+
+/// @brief Baked noise: SimplexPerlin3D() (noise.glsl) evaluated once at startup by a compute shader
+///        (mvr_noise.comp.glsl) into a 3D texture of NOISE_VOLUME_SIZE^3 texels that repeats every
+///        NOISE_VOLUME_PERIOD noise units. With MVRSettings::m_bakedNoise the scene and shading atlas shaders
+///        sample it trilinearly instead of evaluating the noise per fragment and per tessellated vertex
+///        (see mvr_noise.glsl), the fragment load then counts octaves of one texture fetch each
+///        (only the first NOISE_VOLUME_OCTAVES are resolved by the volume).
+class NoiseVolume
+{
+public:
+  /// @brief Compiles the compute shader and bakes the volume, requires a current context.
+  bool init();
+  void deinit();
+  /// @brief Recompiles the compute shader and bakes the volume again.
+  void reloadShaders();
+
+  void bindTexture() const { glBindTextureUnit(TEX_NOISE_VOLUME, m_texture); }
+
+  /// @brief GPU time of the last bake.
+  double getBakeMilliseconds() const { return m_bakeMilliseconds; }
+  uint64_t getBytes() const { return m_texture ? uint64_t(NOISE_VOLUME_SIZE) * NOISE_VOLUME_SIZE * NOISE_VOLUME_SIZE * 2 : 0; }
+
+  void reportMemory(MemoryReport& report) const;
+
+private:
+  void bake();
+
+  nvgl::ProgramManager m_progManager;
+  nvgl::ProgramID      m_program;
+
+  GLuint m_texture          = 0;  // GL_R16F
+  double m_bakeMilliseconds = 0.0;
+};
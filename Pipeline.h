@@ -19,95 +19,369 @@
 
 #pragma once
 
-#include "nvgl/programmanager_gl.hpp"
 #include "nvgl/base_gl.hpp"
 
+#include "GLStateCache.h"
+#include "MemoryReport.h"
+#include "ProgramCache.h"
+
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
 /// @brief Shader search paths
 extern std::vector<std::string> defaultSearchPaths;
 
+/// @brief How the per object data gets uploaded to the GPU
+enum class ObjectUpdateStrategy
+{
+  BUFFER_SUB_DATA,  // one glNamedBufferSubData + glBindBufferBase per draw, the baseline
+  PERSISTENT_RING,  // written once per frame into a persistently mapped ring, bound by offset
+};
+
 /// @brief A simple shader pipeline with two UBOs: one for scene data and one for per object data.
 ///        Contains the boilerplate code that will be shared between different demos.
+///        Alternatively all objects of a frame can be bound at once as an SSBO array (e.g. for multi draw indirect).
 /// @tparam SCENE_DATA Global demo specific toggles etc.
 /// @tparam OBJECT_DATA Camera matrices and per object data (e.g. color)
 template <class SCENE_DATA, class OBJECT_DATA>
 class Pipeline
 {
 public:
-  Pipeline(GLuint sceneBufferIndex, GLuint objectBufferIndex)
+  using ObjectData = OBJECT_DATA;
+
+  Pipeline(GLuint sceneBufferIndex, GLuint objectBufferIndex, GLuint objectArrayBufferIndex)
       : m_sceneBufferIndex(sceneBufferIndex)
       , m_objectBufferIndex(objectBufferIndex)
+      , m_objectArrayBufferIndex(objectArrayBufferIndex)
   {
-    nvgl::newBuffer(m_sceneUbo);
+    GLStateCache::get().newBuffer(m_sceneUbo);
     glNamedBufferData(m_sceneUbo, sizeof(SCENE_DATA), nullptr, GL_DYNAMIC_DRAW);
 
-    nvgl::newBuffer(m_objectUbo);
+    GLStateCache::get().newBuffer(m_objectUbo);
     glNamedBufferData(m_objectUbo, sizeof(OBJECT_DATA), nullptr, GL_DYNAMIC_DRAW);
 
+    // each object bound as UBO has to start at a valid uniform buffer offset,
+    // as an SSBO array the objects are packed with the std430 array stride
+    GLint uboAlignment  = 256;
+    GLint ssboAlignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssboAlignment);
+    m_uboStride        = alignUp(sizeof(OBJECT_DATA), uboAlignment);
+    m_arrayStride      = alignUp(sizeof(OBJECT_DATA), 16);
+    m_segmentAlignment = std::max(uboAlignment, ssboAlignment);
+    m_objectStride     = m_uboStride;
+
     for(const auto& path : defaultSearchPaths)
     {
-      m_progManager.addDirectory(path);
+      m_programCache.addDirectory(path);
     }
   };
   virtual ~Pipeline()
   {
-    m_progManager.deletePrograms();
-    nvgl::deleteBuffer(m_sceneUbo);
-    nvgl::deleteBuffer(m_objectUbo);
+    m_programCache.deletePrograms();
+    GLStateCache::get().deleteBuffer(m_sceneUbo);
+    GLStateCache::get().deleteBuffer(m_objectUbo);
+    GLStateCache::get().deleteBuffer(m_objectSsbo);
+    deleteObjectRing();
   };
 
-  /// @brief Sets the model matrix internally, update on the GPU via updateObjectUniforms()
+  /// @brief Sets the model matrix internally, update on the GPU via storeObject()
   void setModelMatrix(const glm::mat4& modelMatrix) { m_modelMatrix = modelMatrix; }
 
-  /// @brief Sets the view matrix internally, update on the GPU via updateObjectUniforms()
+  /// @brief Sets the view matrix internally, update on the GPU via storeObject()
   void setViewMatrix(const glm::mat4& viewMatrix) { m_viewMatrix = viewMatrix; }
 
-  /// @brief Sets the projection matrix internally, update on the GPU via updateObjectUniforms()
+  /// @brief Sets the projection matrix internally, update on the GPU via storeObject()
   void setProjectionMatrix(const glm::mat4& projectionMatrix) { m_projectionMatrix = projectionMatrix; }
 
-  /// @brief Reload all shaders from disk (e.g. to live edit shaders)
-  void reloadShaders() { m_progManager.reloadPrograms(); }
+  const glm::mat4& getViewMatrix() const { return m_viewMatrix; }
+  const glm::mat4& getProjectionMatrix() const { return m_projectionMatrix; }
+
+  /// @brief Reload all shaders from disk (e.g. to live edit shaders), only programs with changed sources get rebuilt
+  void reloadShaders()
+  {
+    m_programCache.resetStatistics();
+    m_programCache.reloadPrograms();
+  }
+  /// @brief How the programs were built since startup or the last reloadShaders()
+  const ProgramCache::Statistics& getProgramStatistics() const { return m_programCache.getStatistics(); }
+  ProgramCache::Progress          getProgramProgress() const { return m_programCache.getProgress(); }
+  /// @brief Compiles the programs which weren't used yet in the background, call once per frame
+  void buildProgramsInBackground() { m_programCache.buildInBackground(); }
 
   /// @brief Use the shader pipeline
-  virtual void setShaderProgram() { glUseProgram(m_progManager.get(m_program)); }
+  virtual void setShaderProgram() { GLStateCache::get().useProgram(m_programCache.get(m_program)); }
   virtual void updateSceneUniforms();
-  virtual void updateObjectUniforms();
+
+  /// @brief Selects how storeObject()/bindObject() get the object data to the GPU, takes effect with the next beginObjects()
+  void                 setObjectUpdateStrategy(ObjectUpdateStrategy strategy) { m_objectUpdateStrategy = strategy; }
+  ObjectUpdateStrategy getObjectUpdateStrategy() const { return m_objectUpdateStrategy; }
+
+  /// @brief Store the objects packed for bindObjectArray() instead of bindObject(), takes effect with the next beginObjects()
+  void setObjectArrayLayout(bool arrayLayout) { m_objectArrayLayout = arrayLayout; }
+
+  /// @brief Starts the per object data of a new frame with numObjects objects.
+  ///        With the ring this waits until the GPU is done with the frame that used the same part of the ring.
+  void beginObjects(uint32_t numObjects);
+  /// @brief Calculates objectData from the current matrices and stores it as object 'index'
+  void storeObject(uint32_t index);
+  /// @brief Stores already calculated object data as object 'index'. The per torus data of the demo is written
+  ///        by the BatchTransform kernels straight into getObjectStorage() instead.
+  void storeObject(uint32_t index, const OBJECT_DATA& data);
+  /// @brief Direct access to the object data of the current frame (after beginObjects()),
+  ///        object 'index' starts at index * getObjectStride()
+  uint8_t*   getObjectStorage();
+  GLsizeiptr getObjectStride() const { return m_objectStride; }
+  /// @brief Makes object 'index' the object data of the following draw calls
+  void bindObject(uint32_t index);
+  /// @brief Binds all objects of the frame as one SSBO array, requires setObjectArrayLayout(true)
+  void bindObjectArray();
+  /// @brief Call after the last draw call of the frame which uses the object data
+  void endObjects();
+
+  /// @brief Adds the uniform buffers and the object storage to the report
+  void reportMemory(MemoryReport& report) const;
 
   SCENE_DATA  sceneData{};
   OBJECT_DATA objectData{};
 
 protected:
+  /// @brief Fills objectData based on the matrices, derived pipelines add their own data
+  virtual void updateObjectData();
+
   glm::mat4 m_modelMatrix{};
   glm::mat4 m_viewMatrix{};
   glm::mat4 m_projectionMatrix{};
 
-  nvgl::ProgramManager m_progManager;
+  ProgramCache m_programCache;
+
+  GLuint m_objectUbo              = 0;
+  GLuint m_sceneUbo               = 0;
+  GLuint m_sceneBufferIndex       = 0;
+  GLuint m_objectBufferIndex      = 1;
+  GLuint m_objectArrayBufferIndex = 2;
+
+  ProgramCache::ProgramID m_program = ProgramCache::INVALID_PROGRAM;
 
-  GLuint m_objectUbo         = 0;
-  GLuint m_sceneUbo          = 0;
-  GLuint m_sceneBufferIndex  = 0;
-  GLuint m_objectBufferIndex = 1;
+private:
+  static GLsizeiptr alignUp(GLsizeiptr size, GLsizeiptr alignment) { return ((size + alignment - 1) / alignment) * alignment; }
 
-  nvgl::ProgramID m_program;
+  GLintptr objectOffset(uint32_t index) const { return GLintptr(index) * m_objectStride; }
+  void     deleteObjectRing();
+
+  ObjectUpdateStrategy m_objectUpdateStrategy = ObjectUpdateStrategy::PERSISTENT_RING;
+  ObjectUpdateStrategy m_activeStrategy       = ObjectUpdateStrategy::PERSISTENT_RING;
+  bool                 m_objectArrayLayout    = false;
+  uint32_t             m_numObjects           = 0;
+
+  GLsizeiptr m_uboStride        = 0;
+  GLsizeiptr m_arrayStride      = 0;
+  GLsizeiptr m_segmentAlignment = 0;
+  GLsizeiptr m_objectStride     = 0;  // stride of the current frame, one of the two above
+
+  // BUFFER_SUB_DATA: objects are kept on the CPU until the draw call needs them,
+  // for the array layout they get uploaded at once into m_objectSsbo
+  std::vector<uint8_t> m_objectStaging;
+  GLuint               m_objectSsbo         = 0;
+  GLsizeiptr           m_objectSsboSize     = 0;
+  bool                 m_objectSsboUploaded = false;
+
+  // PERSISTENT_RING: one segment per frame in flight, each holding m_ringCapacity objects
+  static const uint32_t RING_FRAMES = 3;
+  GLuint                m_objectRing              = 0;
+  uint8_t*              m_objectRingMapping       = nullptr;
+  GLsync                m_ringFences[RING_FRAMES] = {};
+  uint32_t              m_ringSegment             = 0;
+  uint32_t              m_ringCapacity            = 0;
+  GLsizeiptr            m_ringStride              = 0;
+  GLsizeiptr            m_ringSegmentSize         = 0;
 };
 
 template <class SCENE_DATA, class OBJECT_DATA>
 inline void Pipeline<SCENE_DATA, OBJECT_DATA>::updateSceneUniforms()
 {
   glNamedBufferSubData(m_sceneUbo, 0, sizeof(SCENE_DATA), &sceneData);
-  glBindBufferBase(GL_UNIFORM_BUFFER, m_sceneBufferIndex, m_sceneUbo);
+  GLStateCache::get().bindBufferBase(GL_UNIFORM_BUFFER, m_sceneBufferIndex, m_sceneUbo);
 }
 
 template <class SCENE_DATA, class OBJECT_DATA>
-inline void Pipeline<SCENE_DATA, OBJECT_DATA>::updateObjectUniforms()
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::updateObjectData()
 {
   objectData.model         = m_modelMatrix;
   objectData.modelView     = m_viewMatrix * m_modelMatrix;
   objectData.modelViewIT   = glm::transpose(glm::inverse(objectData.modelView));
   objectData.modelViewProj = m_projectionMatrix * m_viewMatrix * m_modelMatrix;
+}
 
-  glNamedBufferSubData(m_objectUbo, 0, sizeof(OBJECT_DATA), &objectData);
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::beginObjects(uint32_t numObjects)
+{
+  m_activeStrategy     = m_objectUpdateStrategy;
+  m_objectStride       = m_objectArrayLayout ? m_arrayStride : m_uboStride;
+  m_numObjects         = numObjects;
+  m_objectSsboUploaded = false;
+
+  if(m_activeStrategy == ObjectUpdateStrategy::BUFFER_SUB_DATA)
+  {
+    m_objectStaging.resize(numObjects * m_objectStride);
+    return;
+  }
+
+  // e.g. the instanced grid, which derives the object data in the vertex shader: no ring segment is used
+  // (a ring of 0 objects can't be created or mapped) and endObjects() sets no fence
+  if(numObjects == 0)
+  {
+    return;
+  }
 
-  glBindBufferBase(GL_UNIFORM_BUFFER, m_objectBufferIndex, m_objectUbo);
+  m_ringSegment = (m_ringSegment + 1) % RING_FRAMES;
+
+  if(numObjects > m_ringCapacity || m_objectStride != m_ringStride)
+  {
+    // (re)create the ring, the GPU must not read from the old one anymore
+    deleteObjectRing();
+
+    if(numObjects > m_ringCapacity)
+    {
+      m_ringCapacity = std::max(numObjects, m_ringCapacity * 2);
+    }
+    m_ringStride      = m_objectStride;
+    m_ringSegmentSize = alignUp(m_ringStride * m_ringCapacity, m_segmentAlignment);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLStateCache::get().newBuffer(m_objectRing);
+    glNamedBufferStorage(m_objectRing, m_ringSegmentSize * RING_FRAMES, nullptr, flags);
+    m_objectRingMapping = (uint8_t*)glMapNamedBufferRange(m_objectRing, 0, m_ringSegmentSize * RING_FRAMES, flags);
+  }
+  else if(m_ringFences[m_ringSegment])
+  {
+    // wait for the frame which used this segment RING_FRAMES frames ago
+    glClientWaitSync(m_ringFences[m_ringSegment], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(m_ringFences[m_ringSegment]);
+    m_ringFences[m_ringSegment] = nullptr;
+  }
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::storeObject(uint32_t index)
+{
+  updateObjectData();
+  storeObject(index, objectData);
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::storeObject(uint32_t index, const OBJECT_DATA& data)
+{
+  assert(index < m_numObjects);
+
+  if(m_activeStrategy == ObjectUpdateStrategy::BUFFER_SUB_DATA)
+  {
+    memcpy(m_objectStaging.data() + objectOffset(index), &data, sizeof(OBJECT_DATA));
+  }
+  else
+  {
+    memcpy(m_objectRingMapping + m_ringSegment * m_ringSegmentSize + objectOffset(index), &data, sizeof(OBJECT_DATA));
+  }
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline uint8_t* Pipeline<SCENE_DATA, OBJECT_DATA>::getObjectStorage()
+{
+  if(m_activeStrategy == ObjectUpdateStrategy::BUFFER_SUB_DATA)
+  {
+    return m_objectStaging.data();
+  }
+  return m_objectRingMapping + m_ringSegment * m_ringSegmentSize;
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::bindObject(uint32_t index)
+{
+  assert(!m_objectArrayLayout);
+  if(m_activeStrategy == ObjectUpdateStrategy::BUFFER_SUB_DATA)
+  {
+    glNamedBufferSubData(m_objectUbo, 0, sizeof(OBJECT_DATA), m_objectStaging.data() + objectOffset(index));
+    GLStateCache::get().bindBufferBase(GL_UNIFORM_BUFFER, m_objectBufferIndex, m_objectUbo);
+  }
+  else
+  {
+    GLStateCache::get().bindBufferRange(GL_UNIFORM_BUFFER, m_objectBufferIndex, m_objectRing,
+                                        m_ringSegment * m_ringSegmentSize + objectOffset(index), m_objectStride);
+  }
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::bindObjectArray()
+{
+  assert(m_objectArrayLayout);
+  if(m_numObjects == 0)
+    return;
+
+  GLsizeiptr size = m_numObjects * m_objectStride;
+  if(m_activeStrategy == ObjectUpdateStrategy::BUFFER_SUB_DATA)
+  {
+    // upload once per frame, even if bound for multiple passes
+    if(!m_objectSsboUploaded)
+    {
+      if(size > m_objectSsboSize)
+      {
+        GLStateCache::get().newBuffer(m_objectSsbo);
+        glNamedBufferData(m_objectSsbo, size, nullptr, GL_DYNAMIC_DRAW);
+        m_objectSsboSize = size;
+      }
+      glNamedBufferSubData(m_objectSsbo, 0, size, m_objectStaging.data());
+      m_objectSsboUploaded = true;
+    }
+    GLStateCache::get().bindBufferRange(GL_SHADER_STORAGE_BUFFER, m_objectArrayBufferIndex, m_objectSsbo, 0, size);
+  }
+  else
+  {
+    GLStateCache::get().bindBufferRange(GL_SHADER_STORAGE_BUFFER, m_objectArrayBufferIndex, m_objectRing,
+                                        m_ringSegment * m_ringSegmentSize, size);
+  }
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::endObjects()
+{
+  // only if beginObjects() handed out a ring segment this frame
+  if(m_activeStrategy == ObjectUpdateStrategy::PERSISTENT_RING && m_objectRing && m_numObjects > 0)
+  {
+    m_ringFences[m_ringSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::reportMemory(MemoryReport& report) const
+{
+  report.add("Pipeline", "scene UBO", sizeof(SCENE_DATA));
+  report.add("Pipeline", "object UBO", sizeof(OBJECT_DATA));
+  report.add("Pipeline", "object SSBO", m_objectSsbo ? uint64_t(m_objectSsboSize) : 0);
+  report.add("Pipeline", "object ring (persistent)", m_objectRing ? uint64_t(m_ringSegmentSize) * RING_FRAMES : 0);
+}
+
+template <class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::deleteObjectRing()
+{
+  for(GLsync& fence : m_ringFences)
+  {
+    if(fence)
+    {
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  if(m_objectRing)
+  {
+    glUnmapNamedBuffer(m_objectRing);
+    GLStateCache::get().deleteBuffer(m_objectRing);
+    m_objectRing        = 0;
+    m_objectRingMapping = nullptr;
+  }
 }
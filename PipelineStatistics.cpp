@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "PipelineStatistics.h"
+
+#include <cstring>
+
+namespace {
+
+// in the order of PipelineStatistics::Counter
+const GLenum QUERY_TARGETS[PipelineStatistics::NUM_COUNTERS] = {
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_TESS_CONTROL_SHADER_PATCHES_ARB,
+    GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB,
+    GL_GEOMETRY_SHADER_INVOCATIONS,
+    GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED_ARB,
+    GL_CLIPPING_INPUT_PRIMITIVES_ARB,
+    GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB,
+};
+
+}  // namespace
+
+void PipelineStatistics::init()
+{
+  for(Frame& frame : m_frames)
+  {
+    for(uint32_t i = 0; i < NUM_COUNTERS; ++i)
+    {
+      glCreateQueries(QUERY_TARGETS[i], 1, &frame.queries[i]);
+    }
+    frame.pending = false;
+  }
+}
+
+void PipelineStatistics::deinit()
+{
+  for(Frame& frame : m_frames)
+  {
+    if(frame.queries[0])
+    {
+      glDeleteQueries(NUM_COUNTERS, frame.queries);
+      memset(frame.queries, 0, sizeof(frame.queries));
+    }
+    frame.pending = false;
+  }
+  m_values = Values();
+}
+
+void PipelineStatistics::begin()
+{
+  if(!isInitialized() || m_active)
+  {
+    return;
+  }
+
+  Frame& frame = m_frames[m_frameIndex % RING_FRAMES];
+  if(frame.pending)
+  {
+    readBack(frame);
+  }
+
+  // queries of different targets can be active at the same time
+  for(uint32_t i = 0; i < NUM_COUNTERS; ++i)
+  {
+    glBeginQuery(QUERY_TARGETS[i], frame.queries[i]);
+  }
+  m_active = true;
+}
+
+void PipelineStatistics::end()
+{
+  if(!m_active)
+  {
+    return;
+  }
+
+  Frame& frame = m_frames[m_frameIndex % RING_FRAMES];
+  for(uint32_t i = 0; i < NUM_COUNTERS; ++i)
+  {
+    glEndQuery(QUERY_TARGETS[i]);
+  }
+  frame.pending = true;
+  m_active      = false;
+  ++m_frameIndex;
+}
+
+void PipelineStatistics::readBack(Frame& frame)
+{
+  frame.pending = false;
+
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(frame.queries[NUM_COUNTERS - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+  if(!available)
+  {
+    // never wait, drop the frame
+    return;
+  }
+
+  for(uint32_t i = 0; i < NUM_COUNTERS; ++i)
+  {
+    GLuint64 value = 0;
+    glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &value);
+    m_values.counters[i] = value;
+  }
+  m_values.valid = true;
+}
+
+const char* PipelineStatistics::getCounterName(Counter counter)
+{
+  switch(counter)
+  {
+    case VERTEX_SHADER_INVOCATIONS:
+      return "VS invocations";
+    case TESS_CONTROL_SHADER_PATCHES:
+      return "TCS patches";
+    case TESS_EVALUATION_SHADER_INVOCATIONS:
+      return "TES invocations";
+    case GEOMETRY_SHADER_INVOCATIONS:
+      return "GS invocations";
+    case GEOMETRY_SHADER_PRIMITIVES_EMITTED:
+      return "GS primitives";
+    case CLIPPING_INPUT_PRIMITIVES:
+      return "Clipping input";
+    case CLIPPING_OUTPUT_PRIMITIVES:
+      return "Clipping output";
+    case FRAGMENT_SHADER_INVOCATIONS:
+      return "FS invocations";
+    default:
+      return "";
+  }
+}
+
+const char* PipelineStatistics::getColumnName(Counter counter)
+{
+  switch(counter)
+  {
+    case VERTEX_SHADER_INVOCATIONS:
+      return "vsInvocations";
+    case TESS_CONTROL_SHADER_PATCHES:
+      return "tcsPatches";
+    case TESS_EVALUATION_SHADER_INVOCATIONS:
+      return "tesInvocations";
+    case GEOMETRY_SHADER_INVOCATIONS:
+      return "gsInvocations";
+    case GEOMETRY_SHADER_PRIMITIVES_EMITTED:
+      return "gsPrimitives";
+    case CLIPPING_INPUT_PRIMITIVES:
+      return "clippingInput";
+    case CLIPPING_OUTPUT_PRIMITIVES:
+      return "clippingOutput";
+    case FRAGMENT_SHADER_INVOCATIONS:
+      return "fsInvocations";
+    default:
+      return "";
+  }
+}
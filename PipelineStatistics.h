@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+
+/// @brief Counts the work of the shader stages with GL_ARB_pipeline_statistics_query, e.g. to show how much vertex,
+///        tessellation and geometry work Single Pass Stereo and Multi-View Rendering share between the views.
+///        Like GpuTimers the queries go into a ring and are read back a few frames later without waiting.
+class PipelineStatistics
+{
+public:
+  enum Counter
+  {
+    VERTEX_SHADER_INVOCATIONS,
+    TESS_CONTROL_SHADER_PATCHES,
+    TESS_EVALUATION_SHADER_INVOCATIONS,
+    GEOMETRY_SHADER_INVOCATIONS,
+    GEOMETRY_SHADER_PRIMITIVES_EMITTED,
+    CLIPPING_INPUT_PRIMITIVES,
+    CLIPPING_OUTPUT_PRIMITIVES,
+    FRAGMENT_SHADER_INVOCATIONS,
+    NUM_COUNTERS
+  };
+  static const uint32_t RING_FRAMES = 4;
+
+  /// @brief Requires GL_ARB_pipeline_statistics_query.
+  void init();
+  void deinit();
+  bool isInitialized() const { return m_frames[0].queries[0] != 0; }
+
+  /// @brief Counts the GL work between begin() and end(), once per frame.
+  void begin();
+  void end();
+
+  struct Values
+  {
+    uint64_t counters[NUM_COUNTERS] = {};
+    bool     valid                  = false;
+  };
+  /// @brief The counters of the last frame read back.
+  const Values& getValues() const { return m_values; }
+
+  static const char* getCounterName(Counter counter);
+  /// @brief camelCase name for the benchmark results
+  static const char* getColumnName(Counter counter);
+
+private:
+  struct Frame
+  {
+    GLuint queries[NUM_COUNTERS] = {};
+    bool   pending               = false;
+  };
+
+  void readBack(Frame& frame);
+
+  Frame    m_frames[RING_FRAMES];
+  uint32_t m_frameIndex = 0;
+  bool     m_active     = false;
+  Values   m_values;
+};
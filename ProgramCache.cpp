@@ -0,0 +1,558 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ProgramCache.h"
+
+#include "nvgl/contextwindow_gl.hpp"
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+
+typedef void(APIENTRYP PFN_MaxShaderCompilerThreads)(GLuint count);
+
+// bump when the file layout changes
+const uint32_t BINARY_FILE_VERSION = 1;
+
+struct BinaryHeader
+{
+  char     magic[8];
+  uint32_t version;
+  GLenum   format;
+  uint64_t key;
+  uint32_t driverLength;  // followed by the driver string
+  uint32_t binaryLength;  // followed by the program binary
+};
+
+const char BINARY_MAGIC[8] = {'G', 'L', 'P', 'R', 'O', 'G', 'B', 'N'};
+
+// FNV-1a
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+  const uint8_t* bytes = (const uint8_t*)data;
+  for(size_t i = 0; i < size; ++i)
+  {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+uint64_t hashString(uint64_t hash, const std::string& string)
+{
+  // include the length, so the concatenation of several strings is unambiguous
+  uint64_t length = string.size();
+  hash            = hashBytes(hash, &length, sizeof(length));
+  return hashBytes(hash, string.data(), string.size());
+}
+
+std::string getString(GLenum name)
+{
+  const char* string = (const char*)glGetString(name);
+  return string ? string : "";
+}
+
+double elapsedMilliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+}  // namespace
+
+void ProgramCache::addDirectory(const std::string& directory)
+{
+  m_directories.push_back(directory);
+}
+
+void ProgramCache::setCacheDirectory(const std::string& directory)
+{
+  m_cacheDirectory = directory;
+  if(!m_cacheDirectory.empty())
+  {
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDirectory, error);
+    if(error)
+    {
+      LOGW("Can't create the program cache directory %s, compiling all programs from source\n", m_cacheDirectory.c_str());
+      m_cacheDirectory.clear();
+    }
+  }
+}
+
+void ProgramCache::setParallelCompile(bool parallel)
+{
+  m_parallelCompile = false;
+  if(parallel)
+  {
+    // the KHR and ARB versions share the enums, the entry points differ in the suffix only
+    PFN_MaxShaderCompilerThreads maxShaderCompilerThreads =
+        (PFN_MaxShaderCompilerThreads)nvgl::ContextWindow::sysGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    if(!maxShaderCompilerThreads)
+    {
+      maxShaderCompilerThreads =
+          (PFN_MaxShaderCompilerThreads)nvgl::ContextWindow::sysGetProcAddress("glMaxShaderCompilerThreadsARB");
+    }
+    if(maxShaderCompilerThreads)
+    {
+      // let the driver decide how many threads to use
+      maxShaderCompilerThreads(0xFFFFFFFF);
+      m_parallelCompile = true;
+    }
+  }
+}
+
+ProgramCache::ProgramID ProgramCache::addProgram(const std::string& prepend, const std::vector<Definition>& definitions)
+{
+  Program program;
+  program.prepend     = prepend;
+  program.definitions = definitions;
+  m_programs.push_back(program);
+  return ProgramID(m_programs.size() - 1);
+}
+
+ProgramCache::ProgramID ProgramCache::createProgram(const std::string& prepend, const std::vector<Definition>& definitions)
+{
+  const ProgramID id = addProgram(prepend, definitions);
+  buildProgram(id, true);
+  return id;
+}
+
+bool ProgramCache::buildProgram(ProgramID id, bool wait)
+{
+  if(id >= m_programs.size())
+  {
+    return false;
+  }
+
+  Program& program = m_programs[id];
+  if(program.state == State::NOT_BUILT)
+  {
+    startBuild(program);
+  }
+  if(program.state == State::PENDING && (wait || isBuildComplete(program)))
+  {
+    finishBuild(program);
+  }
+  return program.state == State::DONE && program.program != 0;
+}
+
+void ProgramCache::buildInBackground(uint32_t maxPending)
+{
+  if(!m_parallelCompile)
+  {
+    return;
+  }
+
+  uint32_t pending = 0;
+  for(Program& program : m_programs)
+  {
+    if(program.state == State::PENDING)
+    {
+      if(isBuildComplete(program))
+      {
+        finishBuild(program);
+      }
+      else
+      {
+        ++pending;
+      }
+    }
+  }
+
+  // binaries load right away, count them as well to spread the loads over a few frames
+  uint32_t started = 0;
+  for(size_t i = 0; i < m_programs.size() && pending < maxPending && started < maxPending; ++i)
+  {
+    Program& program = m_programs[i];
+    if(program.state == State::NOT_BUILT)
+    {
+      startBuild(program);
+      pending += program.state == State::PENDING ? 1 : 0;
+      ++started;
+    }
+  }
+}
+
+void ProgramCache::deletePrograms()
+{
+  for(Program& program : m_programs)
+  {
+    if(program.state == State::PENDING)
+    {
+      finishBuild(program);
+    }
+    if(program.program)
+    {
+      glDeleteProgram(program.program);
+    }
+  }
+  m_programs.clear();
+}
+
+void ProgramCache::reloadPrograms()
+{
+  for(Program& program : m_programs)
+  {
+    if(program.state == State::NOT_BUILT)
+    {
+      continue;
+    }
+    if(program.state == State::PENDING)
+    {
+      finishBuild(program);
+    }
+    startBuild(program);
+    if(program.state == State::PENDING)
+    {
+      finishBuild(program);
+    }
+  }
+}
+
+bool ProgramCache::areProgramsValid() const
+{
+  for(const Program& program : m_programs)
+  {
+    if(program.state == State::DONE && !program.program)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+ProgramCache::Progress ProgramCache::getProgress() const
+{
+  Progress progress;
+  progress.total = uint32_t(m_programs.size());
+  for(const Program& program : m_programs)
+  {
+    progress.linked += program.program ? 1 : 0;
+    progress.pending += program.state == State::PENDING ? 1 : 0;
+  }
+  return progress;
+}
+
+void ProgramCache::startBuild(Program& program)
+{
+  auto start    = std::chrono::high_resolution_clock::now();
+  program.state = State::DONE;
+
+  if(m_driver.empty())
+  {
+    m_driver = getString(GL_VENDOR) + "|" + getString(GL_RENDERER) + "|" + getString(GL_VERSION);
+  }
+
+  uint64_t                 key = hashString(0xcbf29ce484222325ull, m_driver);
+  std::vector<std::string> sources(program.definitions.size());
+  for(size_t i = 0; i < program.definitions.size(); ++i)
+  {
+    const Definition& definition = program.definitions[i];
+    if(!preprocess(definition.filename, program.prepend, sources[i]))
+    {
+      LOGE("Can't find shader file %s\n", definition.filename.c_str());
+      ++m_statistics.failed;
+      return;
+    }
+    key = hashBytes(key, &definition.type, sizeof(definition.type));
+    key = hashString(key, sources[i]);
+  }
+
+  if(program.program && key == program.key)
+  {
+    // unchanged
+    return;
+  }
+
+  GLuint glProgram = loadBinary(key);
+  if(glProgram)
+  {
+    ++m_statistics.loaded;
+    replaceProgram(program, glProgram, key);
+    m_statistics.milliseconds += elapsedMilliseconds(start);
+    return;
+  }
+
+  // with parallel compilation none of these calls wait for the compiler, the first status query does
+  glProgram = glCreateProgram();
+  for(size_t i = 0; i < sources.size(); ++i)
+  {
+    const char* source = sources[i].c_str();
+    GLuint      shader = glCreateShader(program.definitions[i].type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glAttachShader(glProgram, shader);
+    program.pendingShaders.push_back(shader);
+  }
+  // lets glGetProgramBinary() return the binary after linking
+  glProgramParameteri(glProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  glLinkProgram(glProgram);
+
+  program.pendingProgram = glProgram;
+  program.pendingKey     = key;
+  program.state          = State::PENDING;
+  m_statistics.milliseconds += elapsedMilliseconds(start);
+}
+
+bool ProgramCache::isBuildComplete(const Program& program) const
+{
+  if(!m_parallelCompile)
+  {
+    return true;
+  }
+  GLint complete = GL_FALSE;
+  glGetProgramiv(program.pendingProgram, GL_COMPLETION_STATUS_KHR, &complete);
+  return complete == GL_TRUE;
+}
+
+void ProgramCache::finishBuild(Program& program)
+{
+  auto   start     = std::chrono::high_resolution_clock::now();
+  GLuint glProgram = program.pendingProgram;
+
+  for(size_t i = 0; i < program.pendingShaders.size(); ++i)
+  {
+    GLuint shader = program.pendingShaders[i];
+    GLint  status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if(status != GL_TRUE)
+    {
+      GLint length = 0;
+      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+      std::string log(std::max(length, 1), '\0');
+      glGetShaderInfoLog(shader, length, nullptr, &log[0]);
+      LOGE("%s failed to compile:\n%s\n", program.definitions[i].filename.c_str(), log.c_str());
+    }
+    glDetachShader(glProgram, shader);
+    glDeleteShader(shader);
+  }
+  program.pendingShaders.clear();
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(glProgram, GL_LINK_STATUS, &linked);
+  if(linked == GL_TRUE)
+  {
+    ++m_statistics.compiled;
+    saveBinary(program.pendingKey, glProgram);
+    replaceProgram(program, glProgram, program.pendingKey);
+  }
+  else
+  {
+    GLint length = 0;
+    glGetProgramiv(glProgram, GL_INFO_LOG_LENGTH, &length);
+    std::string log(std::max(length, 1), '\0');
+    glGetProgramInfoLog(glProgram, length, nullptr, &log[0]);
+    LOGE("%s failed to link:\n%s\n", program.definitions[0].filename.c_str(), log.c_str());
+    glDeleteProgram(glProgram);
+    ++m_statistics.failed;
+  }
+
+  program.pendingProgram = 0;
+  program.state          = State::DONE;
+  m_statistics.milliseconds += elapsedMilliseconds(start);
+}
+
+void ProgramCache::replaceProgram(Program& program, GLuint glProgram, uint64_t key)
+{
+  if(program.program)
+  {
+    glDeleteProgram(program.program);
+  }
+  program.program = glProgram;
+  program.key     = key;
+}
+
+std::string ProgramCache::getBinaryFilename(uint64_t key) const
+{
+  char name[32];
+  snprintf(name, sizeof(name), "%016" PRIx64 ".bin", key);
+  return m_cacheDirectory + "/" + name;
+}
+
+GLuint ProgramCache::loadBinary(uint64_t key)
+{
+  if(m_cacheDirectory.empty())
+  {
+    return 0;
+  }
+
+  const std::string filename = getBinaryFilename(key);
+  std::ifstream     file(filename, std::ios::binary);
+  if(!file)
+  {
+    return 0;
+  }
+
+  BinaryHeader header;
+  std::string  driver;
+  std::string  binary;
+  bool         valid = bool(file.read((char*)&header, sizeof(header)));
+  valid = valid && memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 && header.version == BINARY_FILE_VERSION
+          && header.key == key && header.driverLength == m_driver.size();
+  if(valid)
+  {
+    driver.resize(header.driverLength);
+    binary.resize(header.binaryLength);
+    valid = file.read(&driver[0], driver.size()) && file.read(&binary[0], binary.size()) && driver == m_driver;
+  }
+  file.close();
+
+  GLuint program = 0;
+  if(valid)
+  {
+    program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), GLsizei(binary.size()));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(linked != GL_TRUE)
+    {
+      // e.g. the driver was updated without changing its version string
+      glDeleteProgram(program);
+      program = 0;
+      valid   = false;
+    }
+  }
+
+  if(!valid)
+  {
+    LOGI("Rejected stale program binary %s\n", filename.c_str());
+    ++m_statistics.rejected;
+    std::remove(filename.c_str());
+  }
+  return program;
+}
+
+void ProgramCache::saveBinary(uint64_t key, GLuint program) const
+{
+  if(m_cacheDirectory.empty())
+  {
+    return;
+  }
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if(length <= 0)
+  {
+    // no binary formats supported
+    return;
+  }
+
+  BinaryHeader header;
+  std::string  binary(length, '\0');
+  glGetProgramBinary(program, length, &length, &header.format, &binary[0]);
+  memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  header.version      = BINARY_FILE_VERSION;
+  header.key          = key;
+  header.driverLength = uint32_t(m_driver.size());
+  header.binaryLength = uint32_t(length);
+
+  const std::string filename = getBinaryFilename(key);
+  std::ofstream     file(filename, std::ios::binary | std::ios::trunc);
+  file.write((const char*)&header, sizeof(header));
+  file.write(m_driver.data(), m_driver.size());
+  file.write(binary.data(), header.binaryLength);
+  if(!file)
+  {
+    LOGW("Can't write program binary %s\n", filename.c_str());
+  }
+}
+
+std::string ProgramCache::findFile(const std::string& filename) const
+{
+  for(const std::string& directory : m_directories)
+  {
+    std::string path = directory + "/" + filename;
+    if(std::ifstream(path))
+    {
+      return path;
+    }
+  }
+  return std::string();
+}
+
+bool ProgramCache::preprocess(const std::string& filename, const std::string& prepend, std::string& source) const
+{
+  std::vector<std::string> included;
+  source.clear();
+  return appendFile(filename, prepend, included, source);
+}
+
+bool ProgramCache::appendFile(const std::string& filename, const std::string& prepend, std::vector<std::string>& included,
+                              std::string& source) const
+{
+  const std::string path = findFile(filename);
+  std::ifstream     file(path);
+  if(path.empty() || !file)
+  {
+    return false;
+  }
+  included.push_back(filename);
+
+  // the includes of this sample all have include guard semantics, each file is pasted once per stage
+  std::string line;
+  int         lineNumber = 0;
+  while(std::getline(file, line))
+  {
+    ++lineNumber;
+    const size_t first   = line.find_first_not_of(" \t");
+    const bool   include = first != std::string::npos && line.compare(first, 8, "#include") == 0;
+    if(include)
+    {
+      const size_t open  = line.find('"');
+      const size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+      if(close == std::string::npos)
+      {
+        LOGE("%s(%d): malformed #include\n", filename.c_str(), lineNumber);
+        return false;
+      }
+      const std::string name = line.substr(open + 1, close - open - 1);
+      if(std::find(included.begin(), included.end(), name) == included.end())
+      {
+        if(!appendFile(name, std::string(), included, source))
+        {
+          LOGE("%s(%d): can't find %s\n", filename.c_str(), lineNumber, name.c_str());
+          return false;
+        }
+      }
+      // keep the line numbers of compile errors matching the file
+      source += "#line " + std::to_string(lineNumber + 1) + "\n";
+      continue;
+    }
+
+    source += line + "\n";
+    if(!prepend.empty() && first != std::string::npos && line.compare(first, 8, "#version") == 0)
+    {
+      source += prepend;
+      source += "#line " + std::to_string(lineNumber + 1) + "\n";
+    }
+  }
+  return true;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief Builds GL programs from GLSL files and stores the linked binaries on disk (glGetProgramBinary), so later
+///        runs and shader reloads skip compiling and linking programs whose sources did not change.
+///        A binary is keyed by a hash of the preprocessed sources (includes expanded, prepended defines) of all
+///        stages and of the driver's vendor, renderer and version strings. Binaries of other sources or drivers
+///        are never found under the same key, binaries the driver rejects anyway (glProgramBinary fails to link)
+///        are deleted and the program gets compiled from source again.
+///        Programs can be added without building them, they get built on first use with buildProgram() or in the
+///        background with buildInBackground(), which relies on GL_KHR_parallel_shader_compile to not block.
+class ProgramCache
+{
+public:
+  typedef uint32_t      ProgramID;
+  static const ProgramID INVALID_PROGRAM = ~0u;
+
+  struct Definition
+  {
+    GLenum      type;
+    std::string filename;
+  };
+
+  ProgramCache() = default;
+  ~ProgramCache() { deletePrograms(); }
+
+  /// @brief Shader files and their includes are searched in these directories.
+  void addDirectory(const std::string& directory);
+  /// @brief Where the binaries are stored, created if needed. Empty (the default) compiles every program from source.
+  void               setCacheDirectory(const std::string& directory);
+  const std::string& getCacheDirectory() const { return m_cacheDirectory; }
+  /// @brief Use GL_KHR_parallel_shader_compile (or the ARB version), call if the extension is supported.
+  void setParallelCompile(bool parallel);
+  bool getParallelCompile() const { return m_parallelCompile; }
+
+  /// @brief Adds a program made of the stages without building it yet, prepend (e.g. defines) is inserted after the
+  ///        #version line of each stage.
+  ProgramID addProgram(const std::string& prepend, const std::vector<Definition>& definitions);
+  /// @brief addProgram() and buildProgram(), returns an ID even if building failed, so the program can be fixed and reloaded.
+  ProgramID createProgram(const std::string& prepend, const std::vector<Definition>& definitions);
+  /// @brief Starts building the program if it wasn't yet. Returns true if it is linked, with wait == false a program
+  ///        still compiling in parallel returns false instead of blocking.
+  bool buildProgram(ProgramID id, bool wait);
+  /// @brief Finishes the programs compiled in parallel and starts building the next ones not built yet,
+  ///        keeping at most maxPending in flight. Does nothing without parallel compilation. Call once per frame.
+  void buildInBackground(uint32_t maxPending = 4);
+  void deletePrograms();
+  /// @brief Rebuilds the built programs whose preprocessed sources changed, keeps the old program if the new one fails.
+  ///        Programs not built yet pick up the new sources when they get built.
+  void reloadPrograms();
+
+  GLuint get(ProgramID id) const { return id < m_programs.size() ? m_programs[id].program : 0; }
+  bool   isValid(ProgramID id) const { return get(id) != 0; }
+  bool   isPending(ProgramID id) const { return id < m_programs.size() && m_programs[id].state == State::PENDING; }
+  /// @brief False if one of the built programs failed, programs not built yet don't count.
+  bool areProgramsValid() const;
+
+  struct Progress
+  {
+    uint32_t total   = 0;
+    uint32_t linked  = 0;
+    uint32_t pending = 0;  // compiling in parallel
+  };
+  Progress getProgress() const;
+
+  struct Statistics
+  {
+    uint32_t loaded       = 0;  // from the binary cache
+    uint32_t compiled     = 0;  // from source
+    uint32_t rejected     = 0;  // binaries the driver did not accept
+    uint32_t failed       = 0;  // programs which did not compile or link
+    double   milliseconds = 0.0;  // blocking time, parallel compilation in the background is not included
+  };
+  /// @brief Counts of the programs built since the last resetStatistics().
+  const Statistics& getStatistics() const { return m_statistics; }
+  void              resetStatistics() { m_statistics = Statistics(); }
+
+private:
+  enum class State
+  {
+    NOT_BUILT,
+    PENDING,  // compiling and linking, see finishBuild()
+    DONE,     // linked or failed
+  };
+
+  struct Program
+  {
+    std::string             prepend;
+    std::vector<Definition> definitions;
+    State                   state   = State::NOT_BUILT;
+    GLuint                  program = 0;
+    uint64_t                key     = 0;  // of the sources the program was built from
+
+    GLuint              pendingProgram = 0;
+    uint64_t            pendingKey     = 0;
+    std::vector<GLuint> pendingShaders;
+  };
+
+  // loads the binary or starts compiling the program if its sources changed
+  void startBuild(Program& program);
+  bool isBuildComplete(const Program& program) const;
+  void finishBuild(Program& program);
+  void replaceProgram(Program& program, GLuint glProgram, uint64_t key);
+
+  // the source of one stage with all includes expanded and prepend inserted, false if a file is missing
+  bool        preprocess(const std::string& filename, const std::string& prepend, std::string& source) const;
+  bool        appendFile(const std::string& filename, const std::string& prepend, std::vector<std::string>& included,
+                         std::string& source) const;
+  std::string findFile(const std::string& filename) const;
+  std::string getBinaryFilename(uint64_t key) const;
+
+  GLuint loadBinary(uint64_t key);
+  void   saveBinary(uint64_t key, GLuint program) const;
+
+  std::vector<Program>     m_programs;
+  std::vector<std::string> m_directories;
+  std::string              m_cacheDirectory;
+  std::string              m_driver;  // vendor, renderer and version, queried with the first program
+  bool                     m_parallelCompile = false;
+  Statistics               m_statistics;
+};
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "RenderTargetPool.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+static uint32_t alignUp(uint32_t value, uint32_t alignment)
+{
+  return (std::max(value, 1u) + alignment - 1) / alignment * alignment;
+}
+
+GLuint RenderTargetPool::acquire(const Desc& desc)
+{
+  const uint32_t width  = alignUp(desc.width, GRANULARITY);
+  const uint32_t height = alignUp(desc.height, GRANULARITY);
+
+  // the smallest released texture which covers the request without wasting too much
+  size_t best = m_entries.size();
+  for(size_t i = 0; i < m_entries.size(); ++i)
+  {
+    const Entry& entry = m_entries[i];
+    if(entry.acquired || entry.desc.layers != desc.layers || entry.desc.samples != desc.samples || entry.desc.format != desc.format)
+    {
+      continue;
+    }
+    if(entry.desc.width < width || entry.desc.height < height || entry.desc.width > width + SHRINK_SLACK * GRANULARITY
+       || entry.desc.height > height + SHRINK_SLACK * GRANULARITY)
+    {
+      continue;
+    }
+    if(best == m_entries.size() || getBytes(entry.desc) < getBytes(m_entries[best].desc))
+    {
+      best = i;
+    }
+  }
+
+  if(best == m_entries.size())
+  {
+    Entry entry;
+    entry.desc        = desc;
+    entry.desc.width  = width;
+    entry.desc.height = height;
+    if(desc.samples)
+    {
+      glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE_ARRAY, 1, &entry.texture);
+      glTextureStorage3DMultisample(entry.texture, desc.samples, desc.format, width, height, desc.layers, GL_FALSE);
+    }
+    else
+    {
+      glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &entry.texture);
+      glTextureStorage3D(entry.texture, 1, desc.format, width, height, desc.layers);
+    }
+    m_entries.push_back(entry);
+
+    ++m_statistics.textures;
+    ++m_statistics.allocations;
+    m_statistics.bytes += getBytes(entry.desc);
+    LOGI("render target pool: %u x %u x %u, %u samples allocated\n", width, height, desc.layers, desc.samples);
+  }
+
+  m_entries[best].acquired = true;
+  return m_entries[best].texture;
+}
+
+void RenderTargetPool::release(GLuint texture)
+{
+  for(Entry& entry : m_entries)
+  {
+    if(texture && entry.texture == texture)
+    {
+      entry.acquired      = false;
+      entry.releasedFrame = m_frame;
+    }
+  }
+}
+
+void RenderTargetPool::beginFrame()
+{
+  ++m_frame;
+  for(size_t i = m_entries.size(); i-- > 0;)
+  {
+    if(!m_entries[i].acquired && m_frame - m_entries[i].releasedFrame > UNUSED_FRAMES)
+    {
+      deleteEntry(i);
+    }
+  }
+}
+
+void RenderTargetPool::deinit()
+{
+  while(!m_entries.empty())
+  {
+    deleteEntry(m_entries.size() - 1);
+  }
+}
+
+void RenderTargetPool::deleteEntry(size_t index)
+{
+  glDeleteTextures(1, &m_entries[index].texture);
+  --m_statistics.textures;
+  m_statistics.bytes -= getBytes(m_entries[index].desc);
+  m_entries.erase(m_entries.begin() + index);
+}
+
+void RenderTargetPool::reportMemory(MemoryReport& report, const char* owner) const
+{
+  for(const Entry& entry : m_entries)
+  {
+    const char* format = entry.desc.format == GL_RGBA8 ? "RGBA8" : (entry.desc.format == GL_DEPTH_COMPONENT24 ? "DEPTH24" : "?");
+    char        name[96];
+    snprintf(name, sizeof(name), "%s %ux%ux%u %ux%s", format, entry.desc.width, entry.desc.height, entry.desc.layers,
+             std::max(entry.desc.samples, 1u), entry.acquired ? "" : " (released)");
+    report.add(owner, name, getBytes(entry.desc));
+  }
+}
+
+uint64_t RenderTargetPool::getBytes(const Desc& desc)
+{
+  // all formats used for render targets here have 4 bytes per sample
+  return uint64_t(desc.width) * desc.height * desc.layers * std::max(desc.samples, 1u) * 4;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include "MemoryReport.h"
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Texture arrays to render into, reused instead of reallocated. Allocations are rounded up to
+///        GRANULARITY pixels and a released texture is handed out again for any request it covers with at most
+///        SHRINK_SLACK steps to spare, so resizing the window only reallocates every few dozen pixels. The
+///        caller renders into the lower left width x height pixels (sub-rect viewport). Released textures
+///        are deleted once they weren't used for UNUSED_FRAMES frames.
+class RenderTargetPool
+{
+public:
+  static const uint32_t GRANULARITY   = 64;   // pixels
+  static const uint32_t SHRINK_SLACK  = 4;    // in GRANULARITY steps
+  static const uint32_t UNUSED_FRAMES = 120;
+
+  struct Desc
+  {
+    uint32_t width   = 0;
+    uint32_t height  = 0;
+    uint32_t layers  = 1;
+    uint32_t samples = 0;  // 0: GL_TEXTURE_2D_ARRAY, otherwise GL_TEXTURE_2D_MULTISAMPLE_ARRAY
+    GLenum   format  = GL_RGBA8;
+  };
+
+  /// @brief A texture array of at least desc's size, exclusively owned by the caller until release().
+  GLuint acquire(const Desc& desc);
+  /// @brief Returns the texture to the pool, 0 is ignored.
+  void release(GLuint texture);
+
+  /// @brief Deletes the textures released more than UNUSED_FRAMES frames ago.
+  void beginFrame();
+  /// @brief Deletes all textures, acquired ones included.
+  void deinit();
+
+  struct Statistics
+  {
+    uint32_t textures    = 0;  // in the pool, acquired or not
+    uint32_t allocations = 0;  // since init
+    uint64_t bytes       = 0;  // of all textures, estimated from the formats
+  };
+  const Statistics& getStatistics() const { return m_statistics; }
+
+  /// @brief Adds every texture of the pool, released ones are marked as such.
+  void reportMemory(MemoryReport& report, const char* owner) const;
+
+private:
+  struct Entry
+  {
+    Desc     desc;  // the allocated size
+    GLuint   texture       = 0;
+    bool     acquired      = false;
+    uint64_t releasedFrame = 0;
+  };
+
+  static uint64_t getBytes(const Desc& desc);
+  void            deleteEntry(size_t index);
+
+  std::vector<Entry> m_entries;
+  uint64_t           m_frame = 0;
+  Statistics         m_statistics;
+};
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ShadingAtlas.h"
+#include "GLStateCache.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Search paths for shaders, defined in main.cpp
+extern std::vector<std::string> defaultSearchPaths;
+
+bool ShadingAtlas::init()
+{
+  for(const auto& path : defaultSearchPaths)
+  {
+    m_progManager.addDirectory(path);
+  }
+  m_progManager.registerInclude("common.h", "common.h");
+  m_progManager.registerInclude("noise.glsl", "noise.glsl");
+  m_progManager.registerInclude("mvr_noise.glsl", "mvr_noise.glsl");
+  m_progManager.registerInclude("mvr_shading.glsl", "mvr_shading.glsl");
+  m_progManager.registerInclude("mvr_torus.glsl", "mvr_torus.glsl");
+  m_program = m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "", "mvr_atlas.vert.glsl"),
+                                          nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, "", "mvr_atlas.frag.glsl"));
+  m_bakedNoiseProgram =
+      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "", "mvr_atlas.vert.glsl"),
+                                  nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, "#define BAKED_NOISE\n", "mvr_atlas.frag.glsl"));
+  if(!m_progManager.areProgramsValid())
+  {
+    LOGE("Error loading the shading atlas shaders\n");
+    return false;
+  }
+
+  GLint maxTextureSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+  m_maxSize = std::min(MAX_SIZE, uint32_t(std::max(maxTextureSize, 1)));
+
+  GLStateCache::get().newVertexArray(m_emptyVao);
+  return true;
+}
+
+void ShadingAtlas::deinit()
+{
+  m_progManager.deletePrograms();
+  GLStateCache::get().deleteVertexArray(m_emptyVao);
+  GLStateCache::get().deleteFramebuffer(m_framebuffer);
+  glDeleteTextures(1, &m_texture);
+  m_texture = 0;
+  m_width   = 0;
+  m_height  = 0;
+}
+
+void ShadingAtlas::update(uint32_t numTori, uint32_t tileWidth)
+{
+  const uint32_t maxSize = m_maxSize;
+
+  // power of two tiles, halved until all tori fit
+  m_numTori   = std::max(numTori, 1u);
+  m_tileWidth = MIN_TILE_WIDTH;
+  while(m_tileWidth * 2 <= std::min(tileWidth, maxSize))
+  {
+    m_tileWidth *= 2;
+  }
+  for(;;)
+  {
+    m_tilesPerRow = std::min(m_numTori, maxSize / m_tileWidth);
+    m_rows        = (m_numTori + m_tilesPerRow - 1) / m_tilesPerRow;
+    if(m_rows * (m_tileWidth / TILE_ASPECT) <= maxSize || m_tileWidth == MIN_TILE_WIDTH)
+    {
+      break;
+    }
+    m_tileWidth /= 2;
+  }
+  // the smallest tiles hold 512 x 2048 tori, more than the demo renders, shade() skips any beyond
+  m_rows = std::min(m_rows, maxSize / (m_tileWidth / TILE_ASPECT));
+
+  const uint32_t width  = m_tilesPerRow * m_tileWidth;
+  const uint32_t height = m_rows * (m_tileWidth / TILE_ASPECT);
+  if(width == m_width && height == m_height)
+  {
+    return;
+  }
+  m_width  = width;
+  m_height = height;
+
+  glDeleteTextures(1, &m_texture);
+  glCreateTextures(GL_TEXTURE_2D, 1, &m_texture);
+  glTextureStorage2D(m_texture, 1, GL_RGBA8, GLsizei(m_width), GLsizei(m_height));
+
+  GLStateCache::get().newFramebuffer(m_framebuffer);
+  glNamedFramebufferTexture(m_framebuffer, GL_COLOR_ATTACHMENT0, m_texture, 0);
+
+  LOGI("shading atlas: %u x %u, %u x %u texels per torus\n", m_width, m_height, m_tileWidth, m_tileWidth / TILE_ASPECT);
+}
+
+void ShadingAtlas::shade(uint32_t numViews, bool bakedNoise)
+{
+  GLStateCache& state = GLStateCache::get();
+  state.bindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+  state.useProgram(m_progManager.get(bakedNoise ? m_bakedNoiseProgram : m_program));
+  state.bindVertexArray(m_emptyVao);
+
+  // every visible tile gets overwritten, the tiles of the other tori are never sampled
+  const GLenum colorAttachment = GL_COLOR_ATTACHMENT0;
+  glInvalidateNamedFramebufferData(m_framebuffer, 1, &colorAttachment);
+
+  glViewport(0, 0, GLsizei(m_width), GLsizei(m_height));
+  glDisable(GL_DEPTH_TEST);
+  glUniform1i(UNI_ATLAS_VIEWS, GLint(numViews));
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(std::min(m_numTori, m_tilesPerRow * m_rows)));
+}
+
+void ShadingAtlas::reportMemory(MemoryReport& report) const
+{
+  report.add("ShadingAtlas", "atlas", m_texture ? uint64_t(m_width) * m_height * 4 : 0);
+}
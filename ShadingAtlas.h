@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+#include "nvgl/programmanager_gl.hpp"
+
+#include <glm/glm.hpp>
+#include "common.h"
+#include "MemoryReport.h"
+
+#include <cstdint>
+
+/// @brief Texture-space shading: the view independent part of the torus shading (the noise, ambient and diffuse
+///        light) gets shaded once per frame into an atlas with one tile per torus, addressed by the torus angles
+///        (see mvr_atlas.frag.glsl). The scene fragment shaders of all views only sample it and add the specular
+///        term, so the fragment cost no longer grows with the number of views.
+class ShadingAtlas
+{
+public:
+  // the atlas never gets larger than this in either dimension, the tiles shrink instead
+  static const uint32_t MAX_SIZE       = 4096;
+  static const uint32_t MIN_TILE_WIDTH = 8;
+  static const uint32_t TILE_ASPECT    = 4;  // tile width / height, about the ratio of the torus radii
+
+  /// @brief Compiles the shaders, requires a current context.
+  bool init();
+  void deinit();
+  void reloadShaders() { m_progManager.reloadPrograms(); }
+
+  /// @brief Lays out numTori tiles of tileWidth x tileWidth / TILE_ASPECT texels, (re)allocates the texture if
+  ///        the size changed.
+  void update(uint32_t numTori, uint32_t tileWidth);
+
+  /// @brief Tiles per row, tile width and height in texels and rows of tiles, for SceneDataMVR::atlasLayout.
+  glm::ivec4 getLayout() const { return glm::ivec4(m_tilesPerRow, m_tileWidth, m_tileWidth / TILE_ASPECT, m_rows); }
+
+  /// @brief Shades the tiles of the tori visible in any of the first numViews views of the bound scene UBO
+  ///        (see GLToriDemo::ToriGrid), with bakedNoise from the bound NoiseVolume. Changes the program, the
+  ///        framebuffer, the viewport and disables the depth test.
+  void shade(uint32_t numViews, bool bakedNoise);
+
+  /// @brief Binds the atlas for the scene pass.
+  void bindTexture() const { glBindTextureUnit(TEX_SHADING_ATLAS, m_texture); }
+
+  /// @brief Texels of all tiles, an upper bound of the texels shaded per frame.
+  uint64_t getTexels() const { return uint64_t(m_numTori) * m_tileWidth * (m_tileWidth / TILE_ASPECT); }
+
+  void reportMemory(MemoryReport& report) const;
+
+private:
+  nvgl::ProgramManager m_progManager;
+  nvgl::ProgramID      m_program;
+  nvgl::ProgramID      m_bakedNoiseProgram;  // samples the NoiseVolume
+
+  GLuint m_texture     = 0;  // GL_RGBA8
+  GLuint m_framebuffer = 0;
+  GLuint m_emptyVao    = 0;  // the quads are generated from gl_VertexID and gl_InstanceID
+
+  uint32_t m_maxSize     = MAX_SIZE;  // limited by GL_MAX_TEXTURE_SIZE, queried once in init()
+  uint32_t m_numTori     = 0;
+  uint32_t m_tileWidth   = 0;
+  uint32_t m_tilesPerRow = 1;
+  uint32_t m_rows        = 0;
+  uint32_t m_width       = 0;
+  uint32_t m_height      = 0;
+};
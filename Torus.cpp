@@ -18,16 +18,47 @@
  */
 
 #include "Torus.h"
+#include "GLStateCache.h"
 
 #include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
-Torus::Torus() {}
+namespace {
+
+int16_t packSnorm16(float value)
+{
+  return int16_t(std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+}
+
+// octahedral normal encoding, see "A Survey of Efficient Representations for Independent Unit Vectors",
+// decoded by octDecode() in mvr_scene.vert.glsl
+glm::vec2 octEncode(glm::vec3 n)
+{
+  n = n / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+  glm::vec2 p(n.x, n.y);
+  if(n.z < 0.0f)
+  {
+    p = glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+  }
+  return p;
+}
+
+}  // namespace
+
+Torus::Torus()
+{
+  updateLods();
+}
 
 Torus::~Torus()
 {
-  nvgl::deleteBuffer(m_vbo);
-  nvgl::deleteBuffer(m_ibo);
+  GLStateCache::get().deleteVertexArray(m_vao);
+  GLStateCache::get().deleteBuffer(m_vbo);
+  GLStateCache::get().deleteBuffer(m_ibo);
 }
 
 void Torus::setBufferState()
@@ -37,29 +68,45 @@ void Torus::setBufferState()
     regenerateGeometry();
   }
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glVertexAttribPointer(m_vertexAttributePosition, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
-  glVertexAttribPointer(m_vertexAttributeNormal, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
-                        (GLvoid*)(m_numVertices * 3 * sizeof(float)));
+  GLStateCache::get().bindVertexArray(m_vao);
+}
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+void Torus::unsetBufferState()
+{
+  // the vertex array holds all of the torus' state, leaving it bound lets the next
+  // setBufferState() be skipped by the state cache
+}
 
-  glEnableVertexAttribArray(m_vertexAttributePosition);
-  glEnableVertexAttribArray(m_vertexAttributeNormal);
+void Torus::draw(GLenum primitiveMode, uint32_t lod)
+{
+  const Lod& level       = m_lods[lod];
+  GLsizeiptr indexOffset = level.firstIndex * (m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+  glDrawElementsBaseVertex(primitiveMode, level.indexCount, m_indexType, NV_BUFFER_OFFSET(indexOffset), level.baseVertex);
 }
 
-void Torus::unsetBufferState()
+void Torus::drawInstanced(GLenum primitiveMode, GLsizei instanceCount, uint32_t lod)
 {
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  const Lod& level       = m_lods[lod];
+  GLsizeiptr indexOffset = level.firstIndex * (m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+  glDrawElementsInstancedBaseVertex(primitiveMode, level.indexCount, m_indexType, NV_BUFFER_OFFSET(indexOffset),
+                                    instanceCount, level.baseVertex);
+}
 
-  glDisableVertexAttribArray(m_vertexAttributePosition);
-  glDisableVertexAttribArray(m_vertexAttributeNormal);
+DrawElementsIndirectCommand Torus::getDrawCommand(uint32_t lod) const
+{
+  const Lod&                  level = m_lods[lod];
+  DrawElementsIndirectCommand command;
+  command.count         = level.indexCount;
+  command.instanceCount = 1;
+  command.firstIndex    = level.firstIndex;
+  command.baseVertex    = level.baseVertex;
+  command.baseInstance  = 0;
+  return command;
 }
 
-void Torus::draw(GLenum primitiveMode)
+void Torus::drawMultiIndirect(GLenum primitiveMode, GLsizei drawCount, GLintptr indirectOffset)
 {
-  glDrawElements(primitiveMode, m_numIndices, GL_UNSIGNED_INT, NV_BUFFER_OFFSET(0));
+  glMultiDrawElementsIndirect(primitiveMode, m_indexType, (const void*)indirectOffset, drawCount, 0);
 }
 
 void Torus::setTessellation(uint32_t n, uint32_t m, float innerRadius, float outerRadius)
@@ -83,9 +130,46 @@ void Torus::setTessellation(uint32_t n, uint32_t m, float innerRadius, float out
   m_innerRadius   = innerRadius;
   m_outerRadius   = outerRadius;
 
+  updateLods();
+  m_dataIsUploadedToGPU = false;
+}
+
+void Torus::setLodCount(uint32_t count)
+{
+  count = std::max(1u, count);
+  if(count == m_lodCount)
+  {
+    return;
+  }
+  m_lodCount = count;
+
+  updateLods();
   m_dataIsUploadedToGPU = false;
 }
 
+void Torus::updateLods()
+{
+  // the layout of the shared buffers is known without generating the geometry
+  m_lods.resize(m_lodCount);
+  m_numVertices = 0;
+  m_numIndices  = 0;
+  for(uint32_t lod = 0; lod < m_lodCount; ++lod)
+  {
+    Lod& level       = m_lods[lod];
+    level.n          = std::max(3u, m_tessellationN >> lod);
+    level.m          = std::max(3u, m_tessellationM >> lod);
+    level.baseVertex = m_numVertices;
+    level.firstIndex = m_numIndices;
+    level.indexCount = 6 * level.n * level.m;
+
+    m_numVertices += level.n * level.m;
+    m_numIndices += level.indexCount;
+  }
+
+  // the indices of each level are relative to its base vertex, so the finest level decides
+  m_indexType = m_lods[0].n * m_lods[0].m <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
 void Torus::setVertexAttributeLocations(GLuint position, GLuint normal)
 {
   if(position == m_vertexAttributePosition && normal == m_vertexAttributeNormal)
@@ -99,106 +183,204 @@ void Torus::setVertexAttributeLocations(GLuint position, GLuint normal)
   m_dataIsUploadedToGPU = false;
 }
 
-void Torus::regenerateGeometry()
+void Torus::setVertexFormat(VertexFormat format)
+{
+  if(format == m_vertexFormat)
+  {
+    return;
+  }
+
+  m_vertexFormat        = format;
+  m_dataIsUploadedToGPU = false;
+}
+
+void Torus::setOptimizeIndices(bool optimize)
 {
-  uint32_t n = m_tessellationN;
-  uint32_t m = m_tessellationM;
+  if(optimize == m_optimizeIndices)
+  {
+    return;
+  }
 
-  std::vector<glm::vec3>    vertices;
-  std::vector<glm::vec3>    tangents;
-  std::vector<glm::vec3>    binormals;
-  std::vector<glm::vec3>    normals;
-  std::vector<glm::vec2>    texcoords;
-  std::vector<unsigned int> indices;
+  m_optimizeIndices     = optimize;
+  m_dataIsUploadedToGPU = false;
+}
 
-  unsigned int size_v = (m + 1) * (n + 1);
+GLsizei Torus::getVertexSize() const
+{
+  return m_vertexFormat == VertexFormat::COMPACT_INTERLEAVED ? sizeof(CompactVertex) : 6 * sizeof(float);
+}
 
-  vertices.reserve(size_v);
-  tangents.reserve(size_v);
-  binormals.reserve(size_v);
-  normals.reserve(size_v);
-  texcoords.reserve(size_v);
-  indices.reserve(6 * m * n);
+glm::vec3 Torus::getPositionScale() const
+{
+  if(m_vertexFormat != VertexFormat::COMPACT_INTERLEAVED)
+  {
+    return glm::vec3(1.0f);
+  }
+  // half extents of the bounding box
+  const float radius = m_innerRadius + m_outerRadius;
+  return glm::vec3(radius, m_outerRadius, radius);
+}
 
-  float mf = (float)m;
-  float nf = (float)n;
+void Torus::regenerateGeometry()
+{
+  std::vector<glm::vec3> vertices;
+  std::vector<glm::vec3> normals;
+  std::vector<uint32_t>  indices;
 
-  float phi_step   = 2.0f * glm::pi<float>() / mf;
-  float theta_step = 2.0f * glm::pi<float>() / nf;
+  vertices.reserve(m_numVertices);
+  normals.reserve(m_numVertices);
+  indices.reserve(m_numIndices);
 
-  // Setup vertices and normals
-  // Generate the Torus exactly like the sphere with rings around the origin along the latitudes.
-  for(unsigned int latitude = 0; latitude <= n; latitude++)  // theta angle
+  for(uint32_t lod = 0; lod < m_lodCount; ++lod)
   {
-    float theta    = (float)latitude * theta_step;
-    float sinTheta = sinf(theta);
-    float cosTheta = cosf(theta);
+    uint32_t n = m_lods[lod].n;
+    uint32_t m = m_lods[lod].m;
+
+    float mf = (float)m;
+    float nf = (float)n;
 
-    float radius = m_innerRadius + m_outerRadius * cosTheta;
+    float phi_step   = 2.0f * glm::pi<float>() / mf;
+    float theta_step = 2.0f * glm::pi<float>() / nf;
 
-    for(unsigned int longitude = 0; longitude <= m; longitude++)  // phi angle
+    // Setup vertices and normals
+    // Generate the Torus exactly like the sphere with rings around the origin along the latitudes.
+    // The seams are closed by indexing, each vertex is only stored once.
+    for(unsigned int latitude = 0; latitude < n; latitude++)  // theta angle
     {
-      float phi    = (float)longitude * phi_step;
-      float sinPhi = sinf(phi);
-      float cosPhi = cosf(phi);
+      float theta    = (float)latitude * theta_step;
+      float sinTheta = sinf(theta);
+      float cosTheta = cosf(theta);
 
-      vertices.push_back(glm::vec3(radius * cosPhi, m_outerRadius * sinTheta, radius * -sinPhi));
+      float radius = m_innerRadius + m_outerRadius * cosTheta;
 
-      tangents.push_back(glm::vec3(-sinPhi, 0.0f, -cosPhi));
+      for(unsigned int longitude = 0; longitude < m; longitude++)  // phi angle
+      {
+        float phi    = (float)longitude * phi_step;
+        float sinPhi = sinf(phi);
+        float cosPhi = cosf(phi);
 
-      binormals.push_back(glm::vec3(cosPhi * -sinTheta, cosTheta, sinPhi * sinTheta));
+        vertices.push_back(glm::vec3(radius * cosPhi, m_outerRadius * sinTheta, radius * -sinPhi));
 
-      normals.push_back(glm::vec3(cosPhi * cosTheta, sinTheta, -sinPhi * cosTheta));
+        normals.push_back(glm::vec3(cosPhi * cosTheta, sinTheta, -sinPhi * cosTheta));
+      }
+    }
+
+    const unsigned int columns = m;
 
-      texcoords.push_back(glm::vec2((float)longitude / mf, (float)latitude / nf));
+    // Setup indices, relative to the base vertex of the level
+    std::vector<uint32_t> lodIndices;
+    lodIndices.reserve(6 * m * n);
+    for(unsigned int latitude = 0; latitude < n; latitude++)
+    {
+      const unsigned int nextLatitude = (latitude + 1) % n;
+      for(unsigned int longitude = 0; longitude < m; longitude++)
+      {
+        const unsigned int nextLongitude = (longitude + 1) % m;
+
+        // two triangles
+        lodIndices.push_back(latitude * columns + longitude);          // lower left
+        lodIndices.push_back(latitude * columns + nextLongitude);      // lower right
+        lodIndices.push_back(nextLatitude * columns + longitude);      // upper left
+
+        lodIndices.push_back(nextLatitude * columns + longitude);      // upper left
+        lodIndices.push_back(latitude * columns + nextLongitude);      // lower right
+        lodIndices.push_back(nextLatitude * columns + nextLongitude);  // upper right
+      }
     }
-  }
 
-  const unsigned int columns = m + 1;
+    if(m_optimizeIndices)
+    {
+      optimizeVertexCache(lodIndices, n * m);
+    }
+    if(lod == 0)
+    {
+      m_vertexCacheStatistics = analyzeVertexCache(lodIndices, n * m);
+    }
+    indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+  }
 
-  // Setup indices
-  for(unsigned int latitude = 0; latitude < n; latitude++)
+  GLStateCache::get().newBuffer(m_vbo);
+  if(m_vertexFormat == VertexFormat::COMPACT_INTERLEAVED)
   {
-    for(unsigned int longitude = 0; longitude < m; longitude++)
+    const glm::vec3 positionScale = getPositionScale();
+
+    std::vector<CompactVertex> compactVertices(vertices.size());
+    for(size_t i = 0; i < vertices.size(); ++i)
     {
-      // two triangles
-      indices.push_back(latitude * columns + longitude);        // lower left
-      indices.push_back(latitude * columns + longitude + 1);    // lower right
-      indices.push_back((latitude + 1) * columns + longitude);  // upper left
-
-      indices.push_back((latitude + 1) * columns + longitude);      // upper left
-      indices.push_back(latitude * columns + longitude + 1);        // lower right
-      indices.push_back((latitude + 1) * columns + longitude + 1);  // upper right
+      CompactVertex& vertex = compactVertices[i];
+      glm::vec3      pos    = vertices[i] / positionScale;
+      glm::vec2      normal = octEncode(normals[i]);
+
+      vertex.position[0] = packSnorm16(pos.x);
+      vertex.position[1] = packSnorm16(pos.y);
+      vertex.position[2] = packSnorm16(pos.z);
+      vertex.position[3] = 0;
+      vertex.normal[0]   = packSnorm16(normal.x);
+      vertex.normal[1]   = packSnorm16(normal.y);
     }
+    glNamedBufferData(m_vbo, compactVertices.size() * sizeof(CompactVertex), compactVertices.data(), GL_STATIC_DRAW);
   }
+  else
+  {
+    GLsizeiptr const sizePositionAttributeData = vertices.size() * sizeof(vertices[0]);
+    GLsizeiptr const sizeNormalAttributeData   = normals.size() * sizeof(normals[0]);
 
-  m_numVertices                              = static_cast<GLsizei>(vertices.size());
-  GLsizeiptr const sizePositionAttributeData = vertices.size() * sizeof(vertices[0]);
-  GLsizeiptr const sizeNormalAttributeData   = normals.size() * sizeof(normals[0]);
+    glNamedBufferData(m_vbo, sizePositionAttributeData + sizeNormalAttributeData, nullptr, GL_STATIC_DRAW);
+    glNamedBufferSubData(m_vbo, 0, sizePositionAttributeData, vertices.data());
+    glNamedBufferSubData(m_vbo, sizePositionAttributeData, sizeNormalAttributeData, normals.data());
+  }
 
-  m_numIndices             = static_cast<GLsizei>(indices.size());
-  GLsizeiptr sizeIndexData = indices.size() * sizeof(indices[0]);
+  // 16 bit indices halve the index fetch bandwidth, see updateLods()
+  GLStateCache::get().newBuffer(m_ibo);
+  if(m_indexType == GL_UNSIGNED_SHORT)
+  {
+    std::vector<uint16_t> indices16(indices.begin(), indices.end());
+    glNamedBufferData(m_ibo, indices16.size() * sizeof(uint16_t), indices16.data(), GL_STATIC_DRAW);
+  }
+  else
+  {
+    glNamedBufferData(m_ibo, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+  }
 
-  nvgl::newBuffer(m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizePositionAttributeData + sizeNormalAttributeData, nullptr, GL_STATIC_DRAW);
-  glBufferSubData(GL_ARRAY_BUFFER, 0, sizePositionAttributeData, &vertices[0]);
-  glBufferSubData(GL_ARRAY_BUFFER, sizePositionAttributeData, sizeNormalAttributeData, &normals[0]);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  updateVertexArray();
+  m_dataIsUploadedToGPU = true;
+}
 
-  nvgl::newBuffer(m_ibo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeIndexData, &indices[0], GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+void Torus::updateVertexArray()
+{
+  // a new vertex array instead of respecifying the old one, it is never changed after this
+  GLStateCache::get().newVertexArray(m_vao);
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glVertexAttribPointer(m_vertexAttributePosition, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
-  glVertexAttribPointer(m_vertexAttributeNormal, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (GLvoid*)(sizePositionAttributeData));
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+  if(m_vertexFormat == VertexFormat::COMPACT_INTERLEAVED)
+  {
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(CompactVertex));
+    glVertexArrayAttribFormat(m_vao, m_vertexAttributePosition, 3, GL_SHORT, GL_TRUE, offsetof(CompactVertex, position));
+    glVertexArrayAttribFormat(m_vao, m_vertexAttributeNormal, 2, GL_SHORT, GL_TRUE, offsetof(CompactVertex, normal));
+    glVertexArrayAttribBinding(m_vao, m_vertexAttributePosition, 0);
+    glVertexArrayAttribBinding(m_vao, m_vertexAttributeNormal, 0);
+  }
+  else
+  {
+    // positions and normals are two streams in the same buffer
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, 3 * sizeof(float));
+    glVertexArrayVertexBuffer(m_vao, 1, m_vbo, m_numVertices * 3 * sizeof(float), 3 * sizeof(float));
+    glVertexArrayAttribFormat(m_vao, m_vertexAttributePosition, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribFormat(m_vao, m_vertexAttributeNormal, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(m_vao, m_vertexAttributePosition, 0);
+    glVertexArrayAttribBinding(m_vao, m_vertexAttributeNormal, 1);
+  }
+  glEnableVertexArrayAttrib(m_vao, m_vertexAttributePosition);
+  glEnableVertexArrayAttrib(m_vao, m_vertexAttributeNormal);
 
-  glEnableVertexAttribArray(m_vertexAttributePosition);
-  glEnableVertexAttribArray(m_vertexAttributeNormal);
+  glVertexArrayElementBuffer(m_vao, m_ibo);
+}
 
-  m_dataIsUploadedToGPU = true;
+void Torus::reportMemory(MemoryReport& report) const
+{
+  if(!m_dataIsUploadedToGPU)
+  {
+    return;
+  }
+  report.add("Torus", "vertex buffer", uint64_t(m_numVertices) * getVertexSize());
+  report.add("Torus", "index buffer", uint64_t(m_numIndices) * (m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t)));
 }
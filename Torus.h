@@ -19,66 +19,138 @@
 
 #pragma once
 
-#include "nvh/geometry.hpp"
 #include <glm/glm.hpp>
 #include "nvgl/base_gl.hpp"
 
+#include "MemoryReport.h"
+#include "VertexCacheOptimizer.h"
+
 #include <cstdint>
+#include <vector>
+
+/// one command of glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint  baseVertex;
+  GLuint baseInstance;
+};
 
 class Torus
 {
 public:
+  /// how the vertices are stored on the GPU
+  enum class VertexFormat
+  {
+    FLOAT32_PLANAR,       // float3 position and float3 normal in two streams, 24 bytes per vertex
+    COMPACT_INTERLEAVED,  // snorm16 position relative to the bounds, octahedral snorm16 normal, 12 bytes per vertex
+  };
+
   Torus();
   ~Torus();
 
-  /// sets buffer state, call draw explicitly (reduce redundant state changes if
+  /// binds the torus' vertex array, call draw explicitly (reduce redundant state changes if
   /// multiple objects should be drawn)
   void setBufferState();
 
-  /// just unset, won't restore the state from before setBufferState()!
+  /// nothing to undo, the vertex array stays bound until something else binds one
   void unsetBufferState();
 
+  /// reorder the triangles for post-transform vertex cache reuse
+  void setOptimizeIndices(bool optimize);
+  bool getOptimizeIndices() const { return m_optimizeIndices; }
+
+  /// GL_UNSIGNED_SHORT if all vertices can be addressed with 16 bit, GL_UNSIGNED_INT otherwise
+  GLenum getIndexType() const { return m_indexType; }
+  /// of the current index order, updated when the geometry gets regenerated
+  const VertexCacheStatistics& getVertexCacheStatistics() const { return m_vertexCacheStatistics; }
+
   /// just the draw calls, use this
-  void draw(GLenum primitiveMode = GL_TRIANGLES);
+  void draw(GLenum primitiveMode = GL_TRIANGLES, uint32_t lod = 0);
+
+  /// instanceCount instances of the torus
+  void drawInstanced(GLenum primitiveMode, GLsizei instanceCount, uint32_t lod = 0);
+
+  /// drawCount draws from the commands in the bound GL_DRAW_INDIRECT_BUFFER
+  void drawMultiIndirect(GLenum primitiveMode, GLsizei drawCount, GLintptr indirectOffset = 0);
 
   /// pre-processed tessellation, values for n,m below 3 will be set to 3.
   void setTessellation(uint32_t n, uint32_t m, float innerRadius = 0.8f, float outerRadius = 0.2f);
 
   const uint32_t getTessellationN() const { return m_tessellationN; }
   const uint32_t getTessellationM() const { return m_tessellationM; }
+  const float    getInnerRadius() const { return m_innerRadius; }
+  const float    getOuterRadius() const { return m_outerRadius; }
+
+  /// number of levels of detail, level l is tessellated with N/2^l x M/2^l (at least 3 x 3),
+  /// all of them share one vertex and one index buffer
+  void           setLodCount(uint32_t count);
+  const uint32_t getLodCount() const { return uint32_t(m_lods.size()); }
+  const uint32_t getLodTessellationN(uint32_t lod) const { return m_lods[lod].n; }
+  const uint32_t getLodTessellationM(uint32_t lod) const { return m_lods[lod].m; }
+
+  /// single instance draw command for a level of detail, baseInstance is 0
+  DrawElementsIndirectCommand getDrawCommand(uint32_t lod) const;
 
   void setVertexAttributeLocations(GLuint position, GLuint normal);
 
-  const GLsizei getTriangleCount() const { return m_numIndices / 3; }
+  void         setVertexFormat(VertexFormat format);
+  VertexFormat getVertexFormat() const { return m_vertexFormat; }
+  GLsizei      getVertexSize() const;
+
+  /// the shaders multiply the stored positions by this to get model space positions
+  glm::vec3 getPositionScale() const;
+
+  const GLsizei getVertexCount(uint32_t lod = 0) const { return m_lods[lod].n * m_lods[lod].m; }
+  const GLsizei getTriangleCount(uint32_t lod = 0) const { return m_lods[lod].indexCount / 3; }
+  const GLsizei getIndexCount(uint32_t lod = 0) const { return m_lods[lod].indexCount; }
+
+  /// adds the vertex and index buffer of all levels of detail to the report
+  void reportMemory(MemoryReport& report) const;
 
 private:
+  void updateLods();
   void regenerateGeometry();
+  void updateVertexArray();
 
   uint32_t m_tessellationN = 8;
   uint32_t m_tessellationM = 8;
   float    m_innerRadius   = 0.8f;
   float    m_outerRadius   = 0.2f;
 
-  struct Vertex
+  VertexFormat m_vertexFormat = VertexFormat::FLOAT32_PLANAR;
+
+  bool                  m_optimizeIndices = true;
+  GLenum                m_indexType       = GL_UNSIGNED_INT;
+  VertexCacheStatistics m_vertexCacheStatistics;
+
+  struct CompactVertex
+  {
+    int16_t position[4];  // xyz, w unused
+    int16_t normal[2];
+  };
+
+  // where each level of detail is stored in the shared buffers
+  struct Lod
   {
-    Vertex(const nvh::geometry::Vertex& vertex)
-    {
-      position = vertex.position;
-      normal   = vertex.normal;
-      color    = glm::vec4(1.0f);
-    }
-
-    glm::vec4 position;
-    glm::vec4 normal;
-    glm::vec4 color;
+    uint32_t n          = 0;
+    uint32_t m          = 0;
+    GLint    baseVertex = 0;
+    GLuint   firstIndex = 0;
+    GLsizei  indexCount = 0;
   };
+  std::vector<Lod> m_lods;
+  uint32_t         m_lodCount = 1;
 
-  GLsizei m_numVertices = 0;
+  GLsizei m_numVertices = 0;  // of all levels of detail
   GLsizei m_numIndices  = 0;
 
   bool   m_dataIsUploadedToGPU = false;
   GLuint m_vbo                 = 0;
   GLuint m_ibo                 = 0;
+  GLuint m_vao                 = 0;  // immutable, recreated with the geometry
 
   GLuint m_vertexAttributePosition = 0;
   GLuint m_vertexAttributeNormal   = 1;
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// size of the simulated LRU cache the scores are based on
+const int CACHE_SIZE = 32;
+
+struct VertexState
+{
+  int                   cachePosition      = -1;  // -1: not in the cache
+  uint32_t              remainingTriangles = 0;   // not yet emitted triangles using this vertex
+  float                 score              = 0.0f;
+  std::vector<uint32_t> triangles;
+};
+
+float vertexScore(const VertexState& vertex)
+{
+  if(vertex.remainingTriangles == 0)
+  {
+    // no triangles left, the vertex doesn't matter anymore
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if(vertex.cachePosition >= 0)
+  {
+    if(vertex.cachePosition < 3)
+    {
+      // used by the last triangle, a fixed score prevents preferring its own vertices too much
+      score = 0.75f;
+    }
+    else
+    {
+      const float scale = 1.0f / float(CACHE_SIZE - 3);
+      score             = std::pow(1.0f - float(vertex.cachePosition - 3) * scale, 1.5f);
+    }
+  }
+
+  // boost vertices with few triangles left to avoid leaving lone triangles behind
+  score += 2.0f * std::pow(float(vertex.remainingTriangles), -0.5f);
+  return score;
+}
+
+}  // namespace
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t numVertices)
+{
+  const uint32_t numTriangles = uint32_t(indices.size() / 3);
+  if(numTriangles == 0)
+  {
+    return;
+  }
+
+  std::vector<VertexState> vertices(numVertices);
+  for(uint32_t t = 0; t < numTriangles; ++t)
+  {
+    for(uint32_t c = 0; c < 3; ++c)
+    {
+      VertexState& vertex = vertices[indices[t * 3 + c]];
+      vertex.triangles.push_back(t);
+      ++vertex.remainingTriangles;
+    }
+  }
+  for(VertexState& vertex : vertices)
+  {
+    vertex.score = vertexScore(vertex);
+  }
+
+  std::vector<bool> emitted(numTriangles, false);
+
+  std::vector<uint32_t> optimized;
+  optimized.reserve(indices.size());
+
+  // LRU cache of CACHE_SIZE entries, while updating the scores it also holds the up to 3 vertices which just dropped out
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> newCache;
+  cache.reserve(CACHE_SIZE + 3);
+  newCache.reserve(CACHE_SIZE + 3);
+
+  uint32_t scanPosition = 0;  // all triangles before this one have been emitted
+  int64_t  bestTriangle = -1;
+  for(uint32_t emittedTriangles = 0; emittedTriangles < numTriangles; ++emittedTriangles)
+  {
+    if(bestTriangle < 0)
+    {
+      // no candidate in the cache, continue with the next triangle in the original order
+      while(emitted[scanPosition])
+      {
+        ++scanPosition;
+      }
+      bestTriangle = scanPosition;
+    }
+
+    const uint32_t* triangle = &indices[bestTriangle * 3];
+    optimized.insert(optimized.end(), triangle, triangle + 3);
+    emitted[bestTriangle] = true;
+
+    // the triangle's vertices move to the front of the cache
+    newCache.assign(triangle, triangle + 3);
+    for(uint32_t v : cache)
+    {
+      if(v != triangle[0] && v != triangle[1] && v != triangle[2])
+      {
+        newCache.push_back(v);
+      }
+    }
+    for(uint32_t c = 0; c < 3; ++c)
+    {
+      --vertices[triangle[c]].remainingTriangles;
+    }
+
+    // update the scores of all vertices which were or are in the cache
+    for(size_t i = 0; i < newCache.size(); ++i)
+    {
+      VertexState& vertex  = vertices[newCache[i]];
+      vertex.cachePosition = i < CACHE_SIZE ? int(i) : -1;
+      vertex.score         = vertexScore(vertex);
+    }
+
+    // the next triangle is the best one using a cached vertex
+    bestTriangle    = -1;
+    float bestScore = -1.0f;
+    for(size_t i = 0; i < std::min(newCache.size(), size_t(CACHE_SIZE)); ++i)
+    {
+      for(uint32_t t : vertices[newCache[i]].triangles)
+      {
+        if(emitted[t])
+        {
+          continue;
+        }
+        const float score = vertices[indices[t * 3]].score + vertices[indices[t * 3 + 1]].score + vertices[indices[t * 3 + 2]].score;
+        if(score > bestScore)
+        {
+          bestScore    = score;
+          bestTriangle = t;
+        }
+      }
+    }
+
+    newCache.resize(std::min(newCache.size(), size_t(CACHE_SIZE)));
+    cache.swap(newCache);
+  }
+
+  indices.swap(optimized);
+}
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize)
+{
+  VertexCacheStatistics stats;
+  if(indices.empty() || numVertices == 0)
+  {
+    return stats;
+  }
+
+  // FIFO: a vertex is still in the cache if at most cacheSize misses happened since it was inserted
+  std::vector<int64_t> insertedAt(numVertices, -int64_t(cacheSize) - 1);
+  int64_t              misses = 0;
+  for(uint32_t index : indices)
+  {
+    if(misses - insertedAt[index] > int64_t(cacheSize))
+    {
+      insertedAt[index] = misses;
+      ++misses;
+    }
+  }
+
+  stats.acmr = float(misses) / float(indices.size() / 3);
+  stats.atvr = float(misses) / float(numVertices);
+  return stats;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Post-transform vertex cache efficiency of a triangle list
+struct VertexCacheStatistics
+{
+  float acmr = 0.0f;  // average cache miss ratio: transformed vertices per triangle, 0.5 is the best possible for large grids
+  float atvr = 0.0f;  // average transformed vertex ratio: transformed vertices per vertex, 1.0 is the best possible
+};
+
+/// @brief Reorders the triangles of an indexed triangle list for better post-transform vertex cache reuse,
+///        following Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". The winding of each triangle is kept.
+void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t numVertices);
+
+/// @brief Simulates a FIFO post-transform cache with cacheSize entries.
+VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize = 32);
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ViewCompositor.h"
+#include "GLStateCache.h"
+
+#include <glm/glm.hpp>
+#include "common.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <string>
+#include <vector>
+
+// Search paths for shaders, defined in main.cpp
+extern std::vector<std::string> defaultSearchPaths;
+
+bool ViewCompositor::init()
+{
+  for(const auto& path : defaultSearchPaths)
+  {
+    m_progManager.addDirectory(path);
+  }
+  m_progManager.registerInclude("common.h", "common.h");
+  m_composeProgram =
+      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "", "mvr_compose.vert.glsl"),
+                                  nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, "", "mvr_compose.frag.glsl"));
+  m_resolveProgram =
+      m_progManager.createProgram(nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "", "mvr_resolve.comp.glsl"));
+  if(!m_progManager.areProgramsValid())
+  {
+    LOGE("Error loading the view composition shaders\n");
+    return false;
+  }
+
+  GLStateCache::get().newVertexArray(m_emptyVao);
+
+  glCreateSamplers(1, &m_linearSampler);
+  glSamplerParameteri(m_linearSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glSamplerParameteri(m_linearSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glSamplerParameteri(m_linearSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glSamplerParameteri(m_linearSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return true;
+}
+
+void ViewCompositor::deinit()
+{
+  m_progManager.deletePrograms();
+  GLStateCache::get().deleteVertexArray(m_emptyVao);
+  glDeleteSamplers(1, &m_linearSampler);
+  m_linearSampler = 0;
+}
+
+void ViewCompositor::compose(GLuint fbo, const Parameters& parameters)
+{
+  GLStateCache& state = GLStateCache::get();
+  state.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+  state.useProgram(m_progManager.get(m_composeProgram));
+  state.bindVertexArray(m_emptyVao);
+
+  glViewport(0, 0, parameters.targetWidth, parameters.targetHeight);
+  glDisable(GL_DEPTH_TEST);
+  glBindTextureUnit(TEX_COMPOSE_VIEWS, parameters.colorTexArray);
+
+  // window pixel -> view texel, the same nearest neighbor mapping the scaled blit used
+  const GLint gridX = 2;
+  const GLint gridY = parameters.numViews > 2 ? 2 : 1;
+  glUniform4i(UNI_COMPOSE_GRID, gridX, gridY, GLint(parameters.viewWidth), GLint(parameters.viewHeight));
+  glUniform2f(UNI_COMPOSE_SCALE, float(gridX * parameters.viewWidth) / float(parameters.targetWidth),
+              float(gridY * parameters.viewHeight) / float(parameters.targetHeight));
+
+  const MultiResLayout* multiRes = parameters.multiResLayout;
+  if(multiRes)
+  {
+    glUniform4i(UNI_COMPOSE_MULTIRES, multiRes->outerPixels.x, multiRes->centerPixels.x, multiRes->outerPixels.y,
+                multiRes->centerPixels.y);
+    glUniform1f(UNI_COMPOSE_MULTIRES_CENTER, multiRes->center);
+    glBindSampler(TEX_COMPOSE_VIEWS, m_linearSampler);
+  }
+  else
+  {
+    glUniform1f(UNI_COMPOSE_MULTIRES_CENTER, 0.0f);
+  }
+
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+
+  if(multiRes)
+  {
+    // the texture unit is shared with the UI
+    glBindSampler(TEX_COMPOSE_VIEWS, 0);
+  }
+}
+
+void ViewCompositor::resolve(GLuint multisampleTexArray, GLuint resolvedTexArray, uint32_t numViews, uint32_t viewWidth, uint32_t viewHeight)
+{
+  GLStateCache::get().useProgram(m_progManager.get(m_resolveProgram));
+  glBindTextureUnit(TEX_RESOLVE_VIEWS, multisampleTexArray);
+  glBindImageTexture(IMG_RESOLVE_VIEWS, resolvedTexArray, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+  // all views in one dispatch, one layer per z slice
+  glDispatchCompute((viewWidth + RESOLVE_WORKGROUP_SIZE - 1) / RESOLVE_WORKGROUP_SIZE,
+                    (viewHeight + RESOLVE_WORKGROUP_SIZE - 1) / RESOLVE_WORKGROUP_SIZE, numViews);
+
+  // compose() fetches the resolved texels
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+#include "nvgl/programmanager_gl.hpp"
+
+#include "MultiResLayout.h"
+
+#include <cstdint>
+
+/// @brief Composes the rendered views straight into a framebuffer with one fullscreen triangle
+///        (see mvr_compose.frag.glsl). Each window pixel samples its view from the layers of the view
+///        texture array, so the view layout and the framebuffer scaling happen in a single pass instead of
+///        one blit per view plus a blit of the whole window. Multisampled views get resolved before by one
+///        compute dispatch over all layers (see mvr_resolve.comp.glsl). Multi-resolution views (see MultiResLayout)
+///        get un-warped by the same pass.
+class ViewCompositor
+{
+public:
+  /// @brief Compiles the composition and the resolve shaders, requires a current context.
+  bool init();
+  void deinit();
+  void reloadShaders() { m_progManager.reloadPrograms(); }
+
+  struct Parameters
+  {
+    GLuint   colorTexArray = 0;  // GL_TEXTURE_2D_ARRAY
+    uint32_t numViews      = 2;  // 2 side by side, 4 in a 2 x 2 grid
+    uint32_t viewWidth     = 0;  // rendered pixels of each view
+    uint32_t viewHeight    = 0;
+    uint32_t targetWidth   = 0;  // pixels of the framebuffer, the views get scaled to cover it
+    uint32_t targetHeight  = 0;
+
+    const MultiResLayout* multiResLayout = nullptr;  // set if the views are warped, viewWidth/Height are the unwarped size
+  };
+
+  /// @brief Averages the samples of the first numViews layers of a GL_TEXTURE_2D_MULTISAMPLE_ARRAY into the
+  ///        layers of a GL_RGBA8 GL_TEXTURE_2D_ARRAY of the same size. Changes the current program.
+  void resolve(GLuint multisampleTexArray, GLuint resolvedTexArray, uint32_t numViews, uint32_t viewWidth, uint32_t viewHeight);
+
+  /// @brief Overwrites all pixels of fbo, changes the current program, vertex array and viewport
+  ///        and disables depth testing.
+  void compose(GLuint fbo, const Parameters& parameters);
+
+private:
+  nvgl::ProgramManager m_progManager;
+  nvgl::ProgramID      m_composeProgram;
+  nvgl::ProgramID      m_resolveProgram;
+
+  GLuint m_emptyVao      = 0;  // the fullscreen triangle is generated from gl_VertexID
+  GLuint m_linearSampler = 0;  // un-warping multi-resolution views
+};
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "WorkerPool.h"
+#include "CpuTrace.h"
+
+#include <algorithm>
+
+void WorkerPool::init(uint32_t numThreads)
+{
+  deinit();
+
+  if(numThreads == 0)
+  {
+    numThreads = getHardwareThreads();
+  }
+
+  // the workers wait for the first job after this generation, even if they start running after it was posted
+  uint64_t startGeneration;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exit          = false;
+    startGeneration = m_generation;
+  }
+  for(uint32_t i = 1; i < numThreads; ++i)
+  {
+    m_workers.emplace_back(&WorkerPool::workerLoop, this, startGeneration);
+  }
+}
+
+void WorkerPool::deinit()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exit = true;
+  }
+  m_wake.notify_all();
+
+  for(std::thread& worker : m_workers)
+  {
+    worker.join();
+  }
+  m_workers.clear();
+}
+
+void WorkerPool::parallelFor(uint32_t count, uint32_t minBatch, uint32_t batchAlignment, const Job& job)
+{
+  if(count == 0)
+  {
+    return;
+  }
+
+  // a few batches per thread so faster threads can take over the work of slower ones
+  const uint32_t numThreads = getNumThreads();
+  uint32_t       batchSize  = std::max(minBatch, (count + numThreads * 4 - 1) / (numThreads * 4));
+  batchSize                 = std::max(1u, ((batchSize + batchAlignment - 1) / batchAlignment) * batchAlignment);
+
+  if(m_workers.empty() || batchSize >= count)
+  {
+    job(0, count);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_job         = &job;
+    m_count       = count;
+    m_batchSize   = batchSize;
+    m_nextBatch   = 0;
+    m_busyWorkers = uint32_t(m_workers.size());
+    ++m_generation;
+  }
+  m_wake.notify_all();
+
+  runBatches();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+  m_job = nullptr;
+}
+
+void WorkerPool::runBatches()
+{
+  CPU_TRACE_ZONE("Worker batches");
+
+  const uint32_t numBatches = (m_count + m_batchSize - 1) / m_batchSize;
+  for(uint32_t batch = m_nextBatch++; batch < numBatches; batch = m_nextBatch++)
+  {
+    const uint32_t first = batch * m_batchSize;
+    (*m_job)(first, std::min(m_batchSize, m_count - first));
+  }
+}
+
+void WorkerPool::workerLoop(uint64_t startGeneration)
+{
+  CpuTrace::setThreadName("Worker");
+
+  uint64_t generation = startGeneration;
+
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [&] { return m_exit || m_generation != generation; });
+      if(m_exit)
+      {
+        return;
+      }
+      generation = m_generation;
+    }
+
+    runBatches();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      --m_busyWorkers;
+    }
+    m_done.notify_one();
+  }
+}
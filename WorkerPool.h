@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief A fixed pool of worker threads to split the per frame CPU work (e.g. the per torus data) into batches.
+///        The calling thread works on the batches as well, so a pool of 1 thread runs everything inline.
+///        No GL calls are allowed in the jobs, they may only write into already mapped memory.
+class WorkerPool
+{
+public:
+  using Job = std::function<void(uint32_t first, uint32_t count)>;
+
+  WorkerPool() = default;
+  ~WorkerPool() { deinit(); }
+
+  /// @brief Starts numThreads - 1 workers, 0 uses all hardware threads
+  void     init(uint32_t numThreads);
+  void     deinit();
+  uint32_t getNumThreads() const { return uint32_t(m_workers.size()) + 1; }
+
+  /// @brief Calls job for consecutive ranges covering [0, count) and returns once all of them are done.
+  ///        Ranges hold multiples of batchAlignment items (except for the last one) and at least minBatch items.
+  void parallelFor(uint32_t count, uint32_t minBatch, uint32_t batchAlignment, const Job& job);
+
+  static uint32_t getHardwareThreads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+private:
+  // startGeneration: m_generation when the worker was created
+  void workerLoop(uint64_t startGeneration);
+  void runBatches();
+
+  std::vector<std::thread> m_workers;
+  std::mutex               m_mutex;
+  std::condition_variable  m_wake;
+  std::condition_variable  m_done;
+  uint64_t                 m_generation  = 0;  // incremented for each parallelFor()
+  uint32_t                 m_busyWorkers = 0;
+  bool                     m_exit        = false;
+
+  // the current job
+  const Job*            m_job       = nullptr;
+  uint32_t              m_count     = 0;
+  uint32_t              m_batchSize = 0;
+  std::atomic<uint32_t> m_nextBatch{0};
+};
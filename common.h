@@ -23,6 +23,7 @@
 typedef glm::mat4 mat4;
 typedef glm::vec3 vec3;
 typedef glm::vec4 vec4;
+typedef glm::ivec4 ivec4;
 #endif
 
 // general behavior defines
@@ -40,7 +41,42 @@ typedef glm::vec4 vec4;
 #define UBO_SCENE 1
 #define UBO_OBJECT 2
 
+#define SSBO_OBJECT 3
+
+// GPU culling, see GpuCuller
+#define UBO_CULL 4
+#define SSBO_CULL_COMMANDS 5
+#define SSBO_CULL_COUNTS 6
+#define CULL_WORKGROUP_SIZE 64
+
+// view composition, see ViewCompositor
+#define TEX_COMPOSE_VIEWS 0
+#define UNI_COMPOSE_GRID 0
+#define UNI_COMPOSE_SCALE 1
+#define UNI_COMPOSE_MULTIRES 2
+#define UNI_COMPOSE_MULTIRES_CENTER 3
+#define TEX_RESOLVE_VIEWS 0
+#define IMG_RESOLVE_VIEWS 0
+#define RESOLVE_WORKGROUP_SIZE 8
+
+// multi-resolution views, 3 x 3 viewports per view, see MultiResLayout
+#define MULTIRES_VIEWPORTS 9
+#define MULTIRES_VIEWPORT_MASK 0x1FF
+
+// texture-space shading, see ShadingAtlas
+#define TEX_SHADING_ATLAS 0
+#define UNI_ATLAS_VIEWS 0
+
+// baked noise, see NoiseVolume
+#define TEX_NOISE_VOLUME 1
+#define IMG_NOISE_VOLUME 0
+#define NOISE_VOLUME_SIZE 128     // texels per axis
+#define NOISE_VOLUME_PERIOD 16.0  // noise units covered by the volume, it repeats beyond
+#define NOISE_VOLUME_OCTAVES 3    // resolved octaves: 8, 4 and 2 (Nyquist limit) texels per noise unit
+#define NOISE_WORKGROUP_SIZE 4
+
 #define MAX_VIEWS 4
+#define MAX_LODS 8
 
 // Uniform location for the variable that contains the view each pass in the
 // software fallback uses.
@@ -57,6 +93,7 @@ struct ObjectData
   mat4 modelViewIT;    // model -> view for normals
   mat4 modelViewProj;  // model -> proj
   vec3 color;          // model color
+  int  index;          // of the object, e.g. its tile in the shading atlas
 };
 
 
@@ -73,6 +110,26 @@ struct SceneDataMVR
   float projFar;
 
   int fragmentLoadFactor;
+
+  // grid of tori for instanced rendering, see GLToriDemo::updateTori()
+  vec4  gridOrigin;  // x0, y0, dx, dy
+  ivec4 gridSize;    // numX, numY, number of tori, unused
+
+  // vertex format of the torus, see Torus::VertexFormat
+  vec4 vertexDecode;  // xyz: position scale, w: 1 for octahedral encoded normals
+  vec4 torusShape;    // x: inner radius, y: outer radius of the torus
+
+  // texture-space shading, see ShadingAtlas
+  ivec4 atlasLayout;  // tiles per row, tile width and height in texels, rows of tiles
+};
+
+struct CullData
+{
+  vec4  boundingSphere;  // model space, xyz: center, w: radius
+  ivec4 counts;          // objects, views, levels of detail, commands per list
+  ivec4 flags;           // x: one list per view, y: compact the lists (draw count in a buffer)
+  vec4  lodSelection;    // x: viewport height in pixels, y: target ring edge length in pixels
+  ivec4 lods[MAX_LODS];  // per level of detail: first index, index count, base vertex, ring segments
 };
 
 
@@ -88,9 +145,17 @@ layout(std140, binding = UBO_SCENE) uniform sceneBuffer
   SceneDataMVR scene;
 };
 
+#if defined(USE_OBJECT_SSBO)
+// multi draw indirect: all objects of the frame, indexed by the base instance of the draw command
+layout(std430, binding = SSBO_OBJECT) readonly buffer objectBuffer
+{
+  ObjectData objects[];
+};
+#elif !defined(USE_INSTANCED_GRID)  // the instanced grid derives the object data from gl_InstanceID
 layout(std140, binding = UBO_OBJECT) uniform objectBuffer
 {
   ObjectData object;
 };
+#endif
 
 #endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.h"
+#include "noise.glsl"
+#include "mvr_noise.glsl"
+#include "mvr_shading.glsl"
+#include "mvr_torus.glsl"
+
+// Shades the view independent part of one torus per tile: each texel is a point of the torus surface,
+// addressed by its angles (see torusPosition()), lit like mvr_scene.frag.glsl without the specular term.
+// The light is computed in world space, the scene shaders use the view space of view 0 which gives the
+// same diffuse term as the view matrices don't scale.
+
+flat in int torusIndex;
+
+layout(location = 0, index = 0) out vec4 out_Color;
+
+void main()
+{
+  ivec2 tileSize = scene.atlasLayout.yz;
+  ivec2 texel    = ivec2(gl_FragCoord.xy) % tileSize;
+  vec2  angles   = (vec2(texel) + 0.5) / vec2(tileSize);
+
+  vec3 normal;
+  vec3 modelPos = torusPosition(angles, normal);
+
+  ObjectData torus    = gridObject(torusIndex);
+  vec3       worldPos = (torus.model * vec4(modelPos, 1.0)).xyz;
+  normal              = normalize(mat3(torus.model) * normal);
+  vec3 lightDir       = normalize(scene.lightPos_world.xyz - worldPos);
+
+  // scene.fragmentLoadFactor
+  float noiseVal = calcNoise(worldPos * 10, scene.fragmentLoadFactor);
+  vec3  objColor = torus.color + vec3(noiseVal);
+
+  out_Color = calculateDiffuse(normal, lightDir, objColor);
+}
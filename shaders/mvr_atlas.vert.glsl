@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.h"
+#include "mvr_torus.glsl"
+
+// One quad per torus covering its tile of the shading atlas, see ShadingAtlas.
+// Tori outside of the frusta of all views get a degenerate quad and cost no fragments.
+
+layout(location = UNI_ATLAS_VIEWS) uniform int numViews;
+
+flat out int torusIndex;
+
+void main()
+{
+  ObjectData torus = gridObject(gl_InstanceID);
+  torusIndex       = gl_InstanceID;
+
+  // the models scale uniformly
+  vec3  center  = torus.model[3].xyz;
+  float radius  = (scene.torusShape.x + scene.torusShape.y) * length(torus.model[0].xyz);
+  bool  visible = false;
+  for(int v = 0; v < numViews; ++v)
+  {
+    visible = visible || sphereInFrustum(center, radius, scene.viewProjMatrix[v]);
+  }
+
+  // (0,0), (1,0), (0,1), (1,1) as a triangle strip
+  ivec2 tileSize = scene.atlasLayout.yz;
+  ivec2 tile     = ivec2(gl_InstanceID % scene.atlasLayout.x, gl_InstanceID / scene.atlasLayout.x);
+  vec2  corner   = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  vec2  texel    = (vec2(tile) + corner) * vec2(tileSize);
+
+  // the viewport covers the whole atlas
+  vec2 atlasSize = vec2(scene.atlasLayout.xw * tileSize);
+  gl_Position    = visible ? vec4(texel / atlasSize * 2.0 - 1.0, 0.0, 1.0) : vec4(0.0);
+}
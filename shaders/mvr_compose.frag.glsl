@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.h"
+
+// Composes the views of the texture array into the window, see ViewCompositor. The views are laid out
+// left to right, bottom to top like MVRDemo renders them.
+
+layout(binding = TEX_COMPOSE_VIEWS) uniform sampler2DArray views;
+
+layout(location = UNI_COMPOSE_GRID) uniform ivec4 grid;   // views in x and y, pixels of one view
+layout(location = UNI_COMPOSE_SCALE) uniform vec2 scale;  // view pixels per window pixel
+
+// multi-resolution views, see MultiResLayout
+layout(location = UNI_COMPOSE_MULTIRES) uniform ivec4 multiResCells;         // outer and center cell pixels in x, in y
+layout(location = UNI_COMPOSE_MULTIRES_CENTER) uniform float multiResCenter;  // 0: the views are not warped
+
+// NDC of the view -> pixel of the warped target along one axis
+float unwarp(float ndc, int outerPixels, int centerPixels)
+{
+  if(ndc < -multiResCenter)
+  {
+    return (ndc + 1.0) / (1.0 - multiResCenter) * float(outerPixels);
+  }
+  if(ndc <= multiResCenter)
+  {
+    return float(outerPixels) + (ndc + multiResCenter) / (2.0 * multiResCenter) * float(centerPixels);
+  }
+  return float(outerPixels + centerPixels) + (ndc - multiResCenter) / (1.0 - multiResCenter) * float(outerPixels);
+}
+
+layout(location = 0, index = 0) out vec4 out_Color;
+
+void main()
+{
+  ivec2 texel = ivec2(gl_FragCoord.xy * scale);
+  ivec2 view  = min(texel / grid.zw, grid.xy - 1);
+  texel       = min(texel - view * grid.zw, grid.zw - 1);
+  int layer   = view.y * grid.x + view.x;
+
+  if(multiResCenter > 0.0)
+  {
+    // the outer cells have fewer pixels, filter them bilinearly (the sampler clamps to the edge)
+    vec2 ndc    = clamp((gl_FragCoord.xy * scale - vec2(view * grid.zw)) / vec2(grid.zw), 0.0, 1.0) * 2.0 - 1.0;
+    vec2 target = vec2(unwarp(ndc.x, multiResCells.x, multiResCells.y), unwarp(ndc.y, multiResCells.z, multiResCells.w));
+    target      = clamp(target, vec2(0.5), vec2(2 * multiResCells.xz + multiResCells.yw) - 0.5);
+    out_Color   = textureLod(views, vec3(target / vec2(textureSize(views, 0).xy), layer), 0.0);
+    return;
+  }
+
+  out_Color = texelFetch(views, ivec3(texel, layer), 0);
+}
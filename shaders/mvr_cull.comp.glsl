@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.h"
+#include "mvr_torus.glsl"
+
+// Culls each torus against the frusta of all views and picks its level of detail like
+// GLToriDemo::cullTori() and GLToriDemo::selectToriLod(), then writes the indirect draw
+// commands of the visible tori, see GpuCuller.
+
+layout(local_size_x = CULL_WORKGROUP_SIZE) in;
+
+layout(std140, binding = UBO_CULL) uniform cullBuffer
+{
+  CullData cull;
+};
+
+struct DrawCommand
+{
+  uint count;
+  uint instanceCount;
+  uint firstIndex;
+  int  baseVertex;
+  uint baseInstance;
+};
+
+// MAX_VIEWS + 1 lists of cull.counts.w commands: one per view, the last one for the objects visible in any view
+layout(std430, binding = SSBO_CULL_COMMANDS) writeonly buffer commandBuffer
+{
+  DrawCommand commands[];
+};
+
+layout(std430, binding = SSBO_CULL_COUNTS) buffer countBuffer
+{
+  uint drawCounts[];
+};
+
+void writeCommand(uint list, uint slot, uint object, uint lod, bool visible)
+{
+  DrawCommand command;
+  command.count         = uint(cull.lods[lod].y);
+  command.instanceCount = visible ? 1 : 0;
+  command.firstIndex    = uint(cull.lods[lod].x);
+  command.baseVertex    = cull.lods[lod].z;
+  command.baseInstance  = object;
+  commands[list * uint(cull.counts.w) + slot] = command;
+}
+
+void appendCommand(uint list, uint object, uint lod, bool visible)
+{
+  if(cull.flags.y != 0)
+  {
+    // compacted, the draw count is read from drawCounts
+    if(visible)
+    {
+      writeCommand(list, atomicAdd(drawCounts[list], 1u), object, lod, true);
+    }
+  }
+  else
+  {
+    // one command per object
+    writeCommand(list, object, object, lod, visible);
+  }
+}
+
+void main()
+{
+  uint object = gl_GlobalInvocationID.x;
+  if(object >= uint(cull.counts.x))
+  {
+    return;
+  }
+
+  // the models scale uniformly
+  mat4  model  = objects[object].model;
+  vec3  center = (model * vec4(cull.boundingSphere.xyz, 1.0)).xyz;
+  float radius = cull.boundingSphere.w * length(model[0].xyz);
+
+  int   numViews = cull.counts.y;
+  uint  viewMask = 0;
+  float diameter = 0.0;  // largest projected diameter in pixels across all views
+  for(int v = 0; v < numViews; ++v)
+  {
+    if(sphereInFrustum(center, radius, scene.viewProjMatrix[v]))
+    {
+      viewMask |= 1u << v;
+    }
+
+    float depth = -(scene.viewMatrix[v] * vec4(center, 1.0)).z;
+    diameter    = depth <= radius ? 3.402823e38 : max(diameter, radius * scene.projMatrix[v][1][1] / depth * cull.lodSelection.x);
+  }
+
+  // coarsest level whose ring edges are at most cull.lodSelection.y pixels long
+  uint lod = 0;
+  while(lod + 1 < uint(cull.counts.z) && diameter <= cull.lodSelection.y * float(cull.lods[lod + 1].w) / 3.14159265)
+  {
+    ++lod;
+  }
+
+  if(cull.flags.x != 0)
+  {
+    for(int v = 0; v < numViews; ++v)
+    {
+      appendCommand(uint(v), object, lod, (viewMask & (1u << v)) != 0);
+    }
+  }
+  else
+  {
+    appendCommand(MAX_VIEWS, object, lod, viewMask != 0);
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.h"
+#include "noise.glsl"
+
+// Bakes SimplexPerlin3D() into the noise volume, see NoiseVolume. The volume covers NOISE_VOLUME_PERIOD noise
+// units per axis and gets sampled with GL_REPEAT. The noise itself doesn't repeat, so each texel blends the
+// noise of its position shifted by the period towards the 8 corners of the volume, weighted by the distance
+// to the opposite faces: the faces of the volume then match up. The blend is normalized to keep the contrast.
+
+layout(local_size_x = NOISE_WORKGROUP_SIZE, local_size_y = NOISE_WORKGROUP_SIZE, local_size_z = NOISE_WORKGROUP_SIZE) in;
+
+layout(binding = IMG_NOISE_VOLUME, r16f) uniform writeonly image3D noiseVolume;
+
+void main()
+{
+  ivec3 texel = ivec3(gl_GlobalInvocationID);
+  if(any(greaterThanEqual(texel, imageSize(noiseVolume))))
+  {
+    return;
+  }
+
+  vec3 f   = (vec3(texel) + 0.5) / vec3(imageSize(noiseVolume));
+  vec3 pos = f * NOISE_VOLUME_PERIOD;
+
+  float noise   = 0.0;
+  float weights = 0.0;
+  for(int c = 0; c < 8; ++c)
+  {
+    vec3  corner = vec3(c & 1, (c >> 1) & 1, (c >> 2) & 1);
+    vec3  w      = mix(1.0 - f, f, corner);
+    float weight = w.x * w.y * w.z;
+    noise += weight * SimplexPerlin3D(pos - corner * NOISE_VOLUME_PERIOD);
+    weights += weight * weight;
+  }
+  imageStore(noiseVolume, texel, vec4(noise * inversesqrt(weights)));
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+// The noise of the tori. With BAKED_NOISE it is sampled trilinearly from the volume baked at startup
+// (see NoiseVolume), otherwise SimplexPerlin3D() is evaluated. Include after noise.glsl.
+
+#if defined(BAKED_NOISE)
+layout(binding = TEX_NOISE_VOLUME) uniform sampler3D noiseVolume;
+
+float sceneNoise(vec3 pos)
+{
+  // explicit level of detail, also used by the tessellation evaluation shader
+  return textureLod(noiseVolume, pos * (1.0 / NOISE_VOLUME_PERIOD), 0.0).r;
+}
+#else
+float sceneNoise(vec3 pos)
+{
+  return SimplexPerlin3D(pos);
+}
+#endif
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.h"
+
+// Resolves the multisampled views, all layers in one dispatch (z is the layer), see ViewCompositor.
+// A box filter over the samples, like the implicit resolve of glBlitFramebuffer.
+
+layout(local_size_x = RESOLVE_WORKGROUP_SIZE, local_size_y = RESOLVE_WORKGROUP_SIZE) in;
+
+layout(binding = TEX_RESOLVE_VIEWS) uniform sampler2DMSArray views;
+layout(binding = IMG_RESOLVE_VIEWS, rgba8) uniform writeonly image2DArray resolved;
+
+void main()
+{
+  ivec3 texel = ivec3(gl_GlobalInvocationID);
+  if(any(greaterThanEqual(texel.xy, imageSize(resolved).xy)))
+  {
+    return;
+  }
+
+  int  samples = textureSamples(views);
+  vec4 color   = vec4(0.0);
+  for(int s = 0; s < samples; ++s)
+  {
+    color += texelFetch(views, texel, s);
+  }
+  imageStore(resolved, texel, color / float(samples));
+}
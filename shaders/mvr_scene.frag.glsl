@@ -22,6 +22,12 @@
 #extension GL_ARB_shading_language_include : enable
 #include "common.h"
 #include "noise.glsl"
+#include "mvr_noise.glsl"
+#include "mvr_shading.glsl"
+
+#if defined(SHADE_ATLAS)
+#include "mvr_torus.glsl"
+#endif
 
 // inputs in view space
 in Interpolants
@@ -30,38 +36,37 @@ in Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 IN;
 
 layout(location = 0, index = 0) out vec4 out_Color;
 
-float calcNoise(vec3 modelPos, int iterations)
-{  
-  float val = 0;
-  for ( int i = 0; i < iterations; ++i )
-  {
-    val += SimplexPerlin3D(modelPos*20) / iterations;
-  }
-  val = smoothstep(-0.1, 0.1, val);
-  return val;
-}
+#if defined(SHADE_ATLAS)
+// Texture-space shading: the ambient and diffuse term of each torus, shaded once per frame for all views
+// (see mvr_atlas.frag.glsl). Bilinear filtering by hand, each tile wraps around on its own.
+layout(binding = TEX_SHADING_ATLAS) uniform sampler2D shadingAtlas;
 
-vec4 calculateLight(vec3 normal, vec3 eyeDir, vec3 lightDir, vec3 objColor) 
+vec4 sampleAtlas(int object, vec2 angles)
 {
-  // ambient term
-  vec4 ambient_color = vec4( objColor * 0.25, 1.0 );
-  
-  // diffuse term
-  float diffuse_intensity = max(dot(normal, lightDir), 0.0)/1.5;
-  vec4  diffuse_color = diffuse_intensity * vec4(objColor, 1.0);
-  
-  // specular term
-  vec3  R = reflect( -lightDir, normal );
-  float specular_intensity = max( dot( eyeDir, R ), 0.0 );
-  vec4  specular_color = pow(specular_intensity, 10) * vec4(0.8,0.8,0.8,1);
-  
-  return ambient_color + diffuse_color + specular_color;
+  ivec2 tileSize = scene.atlasLayout.yz;
+  ivec2 tile     = ivec2(object % scene.atlasLayout.x, object / scene.atlasLayout.x) * tileSize;
+
+  vec2  texel = angles * vec2(tileSize) - 0.5;
+  ivec2 t0    = ivec2(floor(texel));
+  vec2  f     = texel - vec2(t0);
+  ivec2 t1    = (t0 + 1) % tileSize;
+  t0          = (t0 + tileSize) % tileSize;
+
+  vec4 bottom = mix(texelFetch(shadingAtlas, tile + t0, 0), texelFetch(shadingAtlas, tile + ivec2(t1.x, t0.y), 0), f.x);
+  vec4 top    = mix(texelFetch(shadingAtlas, tile + ivec2(t0.x, t1.y), 0), texelFetch(shadingAtlas, tile + t1, 0), f.x);
+  return mix(bottom, top, f.y);
 }
+#endif
 
 void main()
 {
@@ -70,10 +75,15 @@ void main()
   vec3 eyeDir   = normalize(IN.eyeDir);
   vec3 lightDir = normalize(IN.lightDir);
 
+#if defined(SHADE_ATLAS)
+  // only the specular term depends on the view
+  out_Color = sampleAtlas(IN.object, torusAngles(IN.modelPos)) + calculateSpecular(normal, eyeDir, lightDir);
+#else
   // scene.fragmentLoadFactor
   vec3 pos = IN.worldPos.xyz/IN.worldPos.w;
   float noiseVal = calcNoise(pos*10, scene.fragmentLoadFactor);
-  vec3 objColor = object.color + vec3(noiseVal);
+  vec3 objColor = IN.color + vec3(noiseVal);
 
   out_Color = calculateLight(normal, eyeDir, lightDir, objColor);
+#endif
 }
@@ -30,6 +30,11 @@
 
 #extension GL_ARB_shading_language_include : enable
 
+#if defined(MULTIRES_GS)
+// Multi-resolution views: each primitive goes to all viewports (see MultiResLayout)
+#extension GL_NV_viewport_array2 : require
+#endif
+
 #if defined(STEREO_SPS)
 //////////// SinglePassStereo ////////////
 // Single Pass Stereo
@@ -65,6 +70,11 @@ in Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 vertices[];
 
@@ -74,6 +84,11 @@ out Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 frag;
 
@@ -94,12 +109,25 @@ void main()
     frag.eyeDir   = vertices[i].eyeDir;
     frag.lightDir = vertices[i].lightDir;
     frag.worldPos = vertices[i].worldPos;
+    frag.color    = vertices[i].color;
+#if defined(SHADE_ATLAS)
+    frag.modelPos = vertices[i].modelPos;
+    frag.object   = vertices[i].object;
+#endif
     gl_Position   = gl_in[i].gl_Position;
 
 #if defined(STEREO_SPS)
     gl_SecondaryPositionNV = gl_in[i].gl_SecondaryPositionNV;
 #endif
 
+#if defined(MULTIRES_GS)
+    // multi-resolution: broadcast to all viewports, their scissor rectangles keep one cell each
+    gl_ViewportMask[0] = MULTIRES_VIEWPORT_MASK;
+#if defined(STEREO_SPS)
+    gl_SecondaryViewportMaskNV[0] = MULTIRES_VIEWPORT_MASK;
+#endif
+#endif
+
     EmitVertex();
   }
   EndPrimitive();
@@ -148,6 +176,11 @@ void main()
       frag.eyeDir   = vec3(0.0, 0.0, 1.0);
       frag.lightDir = vec3(0.0, 0.0, 1.0);
       frag.worldPos = vec4(center, 1.0);
+      frag.color    = vertices[0].color;
+#if defined(SHADE_ATLAS)
+      frag.modelPos = (vertices[0].modelPos + vertices[1].modelPos + vertices[2].modelPos) / 3.0;
+      frag.object   = vertices[0].object;
+#endif
 
       vec4 pos    = vec4(center + arrow[3 * t + v], 1.0);
       gl_Position = scene.viewProjMatrix[viewID] * pos;
@@ -156,6 +189,14 @@ void main()
       gl_SecondaryPositionNV = scene.viewProjMatrix[1] * pos;
 #endif
 
+#if defined(MULTIRES_GS)
+      // multi-resolution: broadcast to all viewports, their scissor rectangles keep one cell each
+      gl_ViewportMask[0] = MULTIRES_VIEWPORT_MASK;
+#if defined(STEREO_SPS)
+      gl_SecondaryViewportMaskNV[0] = MULTIRES_VIEWPORT_MASK;
+#endif
+#endif
+
       EmitVertex();
     }
     EndPrimitive();
@@ -60,6 +60,11 @@ in Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 IN[];
 
@@ -69,6 +74,11 @@ out Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 OUT[];
 
@@ -92,4 +102,9 @@ void main(void)
   OUT[gl_InvocationID].eyeDir   = IN[gl_InvocationID].eyeDir;
   OUT[gl_InvocationID].lightDir = IN[gl_InvocationID].lightDir;
   OUT[gl_InvocationID].worldPos = IN[gl_InvocationID].worldPos;
+  OUT[gl_InvocationID].color    = IN[gl_InvocationID].color;
+#if defined(SHADE_ATLAS)
+  OUT[gl_InvocationID].modelPos = IN[gl_InvocationID].modelPos;
+  OUT[gl_InvocationID].object   = IN[gl_InvocationID].object;
+#endif
 }
@@ -26,11 +26,16 @@
  * exposed).
  *
  * This sample shader will tessellatate the input and deform it based on 3D
- * noise in the normal direction.
+ * noise in the normal direction (baked into a volume with BAKED_NOISE).
  */
 
 #extension GL_ARB_shading_language_include : enable
 
+#if defined(MULTIRES_TES)
+// Multi-resolution views: each primitive goes to all viewports (see MultiResLayout)
+#extension GL_NV_viewport_array2 : require
+#endif
+
 #if defined(STEREO_SPS)
 //////////// SinglePassStereo ////////////
 // Single Pass Stereo
@@ -53,6 +58,7 @@ layout(num_views = MVR_VIEWS) in;
 
 #include "common.h"
 #include "noise.glsl"
+#include "mvr_noise.glsl"
 
 layout(triangles, equal_spacing, ccw) in;
 
@@ -64,6 +70,11 @@ in Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 IN[];
 
@@ -73,6 +84,11 @@ out Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;
+  flat int object;
+#endif
 }
 OUT;
 
@@ -100,6 +116,12 @@ void main()
   OUT.normal   = interpolate3(IN[0].normal, IN[1].normal, IN[2].normal);
   OUT.eyeDir   = interpolate3(IN[0].eyeDir, IN[1].eyeDir, IN[2].eyeDir);
   OUT.lightDir = interpolate3(IN[0].lightDir, IN[1].lightDir, IN[2].lightDir);
+  OUT.color    = IN[0].color;
+#if defined(SHADE_ATLAS)
+  // the atlas holds the undisplaced surface, like the lighting parameters below
+  OUT.modelPos = interpolate3(IN[0].modelPos, IN[1].modelPos, IN[2].modelPos);
+  OUT.object   = IN[0].object;
+#endif
 
   vec4 worldPos = interpolate4(IN[0].worldPos, IN[1].worldPos, IN[2].worldPos);
 
@@ -113,12 +135,12 @@ void main()
   float scale     = scene.torusScale;
   float frequency = 1.0 / scale;
   float amplitude = 0.1 * scale;
-  float noise     = SimplexPerlin3D(frequency * worldPos.xyz);
+  float noise     = sceneNoise(frequency * worldPos.xyz);
   vec3  v         = amplitude * normal * noise;
 
   float frequency2 = 7.0 / scale;
   float amplitude2 = 0.02 * scale;
-  noise            = SimplexPerlin3D(frequency2 * worldPos.xyz);
+  noise            = sceneNoise(frequency2 * worldPos.xyz);
   v                = v + amplitude2 * normal * noise;
 
   worldPos.xyz = worldPos.xyz + v;
@@ -128,5 +150,13 @@ void main()
   gl_SecondaryPositionNV = scene.viewProjMatrix[1] * worldPos;
 #endif
 
+#if defined(MULTIRES_TES)
+  // multi-resolution: broadcast to all viewports, their scissor rectangles keep one cell each
+  gl_ViewportMask[0] = MULTIRES_VIEWPORT_MASK;
+#if defined(STEREO_SPS)
+  gl_SecondaryViewportMaskNV[0] = MULTIRES_VIEWPORT_MASK;
+#endif
+#endif
+
   OUT.worldPos = worldPos;
 }
@@ -20,7 +20,12 @@
 #version 450
 
 #extension GL_ARB_shading_language_include : enable
-#extension GL_NV_viewport_array2 : require
+#extension GL_NV_viewport_array2 : enable
+
+#if defined(USE_OBJECT_SSBO)
+// Multi draw indirect: the base instance of each draw command is the object index
+#extension GL_ARB_shader_draw_parameters : require
+#endif
 
 #if defined(STEREO_SPS)
 //////////// SinglePassStereo ////////////
@@ -43,10 +48,11 @@ layout(num_views = MVR_VIEWS) in;
 #endif
 
 #include "common.h"
+#include "mvr_torus.glsl"
 
-// inputs in model space
-in layout(location = VERTEX_POS) vec3 vertex_pos_model;
-in layout(location = VERTEX_NORMAL) vec3 normal;
+// inputs in model space, possibly compressed (see decodeVertex())
+in layout(location = VERTEX_POS) vec3 vertex_pos_stored;
+in layout(location = VERTEX_NORMAL) vec3 normal_stored;
 
 layout(location = OFFSET_FALLBACK_ID) uniform int fallbackViewID;
 
@@ -57,11 +63,44 @@ out Interpolants
   vec3 normal;
   vec3 eyeDir;
   vec3 lightDir;
+  flat vec3 color;
+#if defined(SHADE_ATLAS)
+  vec3 modelPos;  // the torus angles address the shading atlas, see torusAngles()
+  flat int object;
+#endif
 }
 OUT;
 
+vec3 octDecode(vec2 e)
+{
+  vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  if(v.z < 0.0)
+  {
+    v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+  }
+  return normalize(v);
+}
+
+// The compact vertex format stores the positions as snorm16 relative to the torus
+// bounds and the normals octahedral encoded as two snorm16 components.
+void decodeVertex(out vec3 pos, out vec3 normal)
+{
+  pos    = vertex_pos_stored * scene.vertexDecode.xyz;
+  normal = scene.vertexDecode.w != 0.0 ? octDecode(normal_stored.xy) : normal_stored;
+}
+
 void main()
 {
+#if defined(USE_OBJECT_SSBO)
+  ObjectData object = objects[gl_BaseInstanceARB];
+#elif defined(USE_INSTANCED_GRID)
+  ObjectData object = gridObject(gl_InstanceID);
+#endif
+
+  vec3 vertex_pos_model;
+  vec3 normal;
+  decodeVertex(vertex_pos_model, normal);
+
   //////////// SinglePassStereo ////////////
   //
   // Using a viewID to pick the right matrices
@@ -128,6 +167,14 @@ void main()
   gl_Layer               = 0;
 #endif
 
+#if defined(MULTIRES_VS)
+  // multi-resolution: broadcast to all viewports, their scissor rectangles keep one cell each
+  gl_ViewportMask[0] = MULTIRES_VIEWPORT_MASK;
+#if defined(STEREO_SPS)
+  gl_SecondaryViewportMaskNV[0] = MULTIRES_VIEWPORT_MASK;
+#endif
+#endif
+
   //////////// SinglePassStereo ////////////
   //
   // Lighting will get calculated in the view space of view 0
@@ -148,4 +195,10 @@ void main()
   OUT.lightDir = lightPos - pos;
 
   OUT.worldPos = object.model * vec4(vertex_pos_model, 1);
+  OUT.color    = object.color;
+
+#if defined(SHADE_ATLAS)
+  OUT.modelPos = vertex_pos_model;
+  OUT.object   = object.index;
+#endif
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Shading of the tori, shared by the scene fragment shader and the shading atlas (see ShadingAtlas).
+// Only calculateSpecular() depends on the view. Include after mvr_noise.glsl.
+
+float calcNoise(vec3 modelPos, int iterations)
+{  
+#if defined(BAKED_NOISE)
+  // the fragment load is the number of octaves: one trilinear fetch each, at twice the frequency and
+  // half the amplitude of the previous one. The volume only resolves NOISE_VOLUME_OCTAVES octaves, the
+  // ones beyond would alias (and lose the precision of the coordinates), they repeat the highest frequency
+  // at shifted positions instead and only add the cost of their fetch.
+  float val       = 0.0;
+  float amplitude = 1.0;
+  float total     = 0.0;
+  vec3  pos       = modelPos * 20;
+  for ( int i = 0; i < iterations; ++i )
+  {
+    val += amplitude * sceneNoise(pos);
+    total += amplitude;
+    amplitude *= 0.5;
+    if ( i + 1 < NOISE_VOLUME_OCTAVES )
+    {
+      pos *= 2.0;
+    }
+    else
+    {
+      pos += vec3(0.37, 0.61, 0.83) * NOISE_VOLUME_PERIOD;
+    }
+  }
+  val /= total;
+#else
+  float val = 0;
+  for ( int i = 0; i < iterations; ++i )
+  {
+    val += SimplexPerlin3D(modelPos*20) / iterations;
+  }
+#endif
+  val = smoothstep(-0.1, 0.1, val);
+  return val;
+}
+
+// ambient and diffuse term, the light is a point light
+vec4 calculateDiffuse(vec3 normal, vec3 lightDir, vec3 objColor)
+{
+  // ambient term
+  vec4 ambient_color = vec4( objColor * 0.25, 1.0 );
+  
+  // diffuse term
+  float diffuse_intensity = max(dot(normal, lightDir), 0.0)/1.5;
+  vec4  diffuse_color = diffuse_intensity * vec4(objColor, 1.0);
+
+  return ambient_color + diffuse_color;
+}
+
+vec4 calculateSpecular(vec3 normal, vec3 eyeDir, vec3 lightDir)
+{
+  vec3  R = reflect( -lightDir, normal );
+  float specular_intensity = max( dot( eyeDir, R ), 0.0 );
+  return pow(specular_intensity, 10) * vec4(0.8,0.8,0.8,1);
+}
+
+vec4 calculateLight(vec3 normal, vec3 eyeDir, vec3 lightDir, vec3 objColor) 
+{
+  return calculateDiffuse(normal, lightDir, objColor) + calculateSpecular(normal, eyeDir, lightDir);
+}
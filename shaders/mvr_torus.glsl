@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Torus helpers shared by the scene, culling and shading atlas shaders, include after common.h.
+
+// Instanced grid: same layout as GLToriDemo::updateTori() computes on the CPU,
+// evaluated from the instance index instead of read from a buffer.
+ObjectData gridObject(int index)
+{
+  int   numX = scene.gridSize.x;
+  int   i    = index / numX;
+  int   j    = index % numX;
+  float x    = scene.gridOrigin.x + float(j) * scene.gridOrigin.z;
+  float y    = scene.gridOrigin.y + float(i) * scene.gridOrigin.w;
+
+  // scale * translate * rotate around the x axis by +-45 degrees
+  float s     = scene.torusScale;
+  float angle = ((j % 2) != 0 ? -1.0 : 1.0) * radians(45.0);
+  float c     = cos(angle);
+  float sn    = sin(angle);
+
+  ObjectData object;
+  object.model = mat4(s, 0, 0, 0,             //
+                      0, s * c, s * sn, 0,    //
+                      0, -s * sn, s * c, 0,   //
+                      s * x, s * y, 0, 1);
+  object.color = (index % 5) == 4 ? vec3(0, 1, 0) : vec3(0, .7, 1);
+  object.index = index;
+  return object;
+}
+
+// The torus surface as Torus::regenerateGeometry() builds it: phi goes around the axis of revolution,
+// theta around the ring. Both angles are stored divided by 2 pi, e.g. as atlas coordinates.
+vec3 torusPosition(vec2 angles, out vec3 normal)
+{
+  const float TWO_PI = 6.28318530718;
+  float       phi    = angles.x * TWO_PI;
+  float       theta  = angles.y * TWO_PI;
+  float       radius = scene.torusShape.x + scene.torusShape.y * cos(theta);
+
+  normal = vec3(cos(phi) * cos(theta), sin(theta), -sin(phi) * cos(theta));
+  return vec3(radius * cos(phi), scene.torusShape.y * sin(theta), -radius * sin(phi));
+}
+
+// inverse of torusPosition(), in [0, 1) for any model space position off the axis
+vec2 torusAngles(vec3 modelPos)
+{
+  const float TWO_PI = 6.28318530718;
+  float       ring   = length(modelPos.xz) - scene.torusShape.x;
+  return fract(vec2(atan(-modelPos.z, modelPos.x), atan(modelPos.y, ring)) / TWO_PI);
+}
+
+bool sphereInFrustum(vec3 center, float radius, mat4 viewProj)
+{
+  // Gribb/Hartmann: the planes are the sums and differences of the last row with the others
+  vec4 rows[4];
+  for(int r = 0; r < 4; ++r)
+  {
+    rows[r] = vec4(viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]);
+  }
+  for(int p = 0; p < 6; ++p)
+  {
+    vec4 plane = (p % 2 == 0) ? rows[3] + rows[p / 2] : rows[3] - rows[p / 2];
+    if(dot(plane.xyz, center) + plane.w < -radius * length(plane.xyz))
+    {
+      return false;
+    }
+  }
+  return true;
+}